@@ -10,7 +10,10 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     src/data.cpp \
+    src/connectionpool.cpp \
+    src/connectionscan.cpp \
     src/flightgraph.cpp \
+    src/nametable.cpp \
     src/logindialog.cpp \
     src/usermainwindow.cpp \
     src/adminmainwindow.cpp \
@@ -19,7 +22,10 @@ SOURCES += \
 HEADERS += \
     mainwindow.h \
     include/data.h \
+    include/connectionpool.h \
+    include/connectionscan.h \
     include/flightgraph.h \
+    include/nametable.h \
     include/common.h \
     include/logindialog.h \
     include/usermainwindow.h \
@@ -0,0 +1,76 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThreadStorage>
+
+// 一个线程自己的数据库连接和它的预编译语句缓存
+struct PooledConnection {
+    QString name;                          // QSqlDatabase连接名
+    QSqlDatabase database;
+    int generation = 0;                    // 打开时连接池的版本，数据库重新打开后失效
+    int borrowed = 0;                      // 借出未归还的语句数
+    QHash<QString, QSqlQuery*> statements; // SQL -> 空闲的预编译语句
+
+    ~PooledConnection();
+};
+
+// 从语句缓存中借出的预编译语句，析构时结束结果集并归还；
+// 同一条SQL正在使用时（嵌套调用）另外编译一条，用完后丢弃
+class PreparedQuery {
+public:
+    PreparedQuery(PreparedQuery&& other) noexcept;
+    PreparedQuery& operator=(PreparedQuery&& other) noexcept;
+    ~PreparedQuery();
+
+    void addBindValue(const QVariant& value) { query->bindValue(bound++, value); }
+    bool exec();
+    bool next() { return query->next(); }
+    QVariant value(int index) const { return query->value(index); }
+    QVariant value(const QString& name) const { return query->value(name); }
+    QSqlError lastError() const { return query->lastError(); }
+    int numRowsAffected() const { return query->numRowsAffected(); }
+
+private:
+    friend class ConnectionPool;
+    PreparedQuery(PooledConnection* owner, const QString& sql, QSqlQuery* query, bool reusable);
+    void release();
+
+    PooledConnection* owner;
+    QString sql;
+    QSqlQuery* query;
+    bool reusable;
+    int bound = 0;
+};
+
+// SQLite连接池：每个线程第一次访问数据库时打开自己的连接（WAL模式），
+// 读操作之间、读和写之间互不阻塞，写操作由调用方自行串行化
+class ConnectionPool {
+public:
+    ConnectionPool() = default;
+
+    bool open(const QString& path);    // 在当前线程打开连接以检查数据库是否可用
+    void close();
+
+    // 当前线程的连接，数据库重新打开后自动重连
+    QSqlDatabase connection();
+
+    // 当前线程连接上缓存的预编译语句
+    PreparedQuery prepare(const QString& sql);
+
+private:
+    PooledConnection* threadConnection();
+
+    QMutex stateMutex;                 // 保护path和generation
+    QString path;
+    int generation = 0;
+    QThreadStorage<PooledConnection*> connections;
+};
+
+#endif // CONNECTIONPOOL_H
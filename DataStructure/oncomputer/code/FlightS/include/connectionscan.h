@@ -0,0 +1,98 @@
+#ifndef CONNECTIONSCAN_H
+#define CONNECTIONSCAN_H
+
+#include "data.h"
+#include "nametable.h"
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QDateTime>
+
+// 航班图和连接数组中的紧凑表示：时间为自1970年起的分钟数，价格为以分为单位的定点数
+namespace Timetable {
+    inline qint64 toMinutes(const QDateTime& time) { return time.toSecsSinceEpoch() / 60; }
+    inline QDateTime fromMinutes(qint64 minutes) { return QDateTime::fromSecsSinceEpoch(minutes * 60); }
+    inline qint64 toCents(double price) { return qRound64(price * 100); }
+    inline double fromCents(qint64 cents) { return cents / 100.0; }
+}
+
+// 连接扫描算法（Connection Scan Algorithm）
+// 每个航段是一个连接（出发城市、到达城市、起飞和到达时间），全部连接按起飞时间排成一个数组；
+// 最早到达查询从出发时间开始顺序扫描一遍，能赶上的连接就更新到达城市的最早到达时间，
+// 扫描到起飞时间晚于目的地当前最早到达时间时停止，转机次数不限，与城市和航班的数量成线性关系。
+// 同一个航班（行程）的经停航段连续乘坐，不需要转机时间；换乘其他航班需要满足所在城市的最短转机时间。
+// 多准则查询（paretoRoutes）同样扫描一遍，每个城市和行程保存互不支配的一组标号（到达时间、价格、换乘次数）。
+
+// 多准则查询的支配规则：到达时间、价格和换乘次数都不差于另一个方案时，后者被支配而舍弃。
+// 容差大于0时，差距在容差以内也算不差于，得到近似的Pareto集合，方案更少、查询更快
+struct ParetoOptions {
+    int maxTransfers = Constants::MAX_TRANSFER_STOPS;
+    double priceTolerance = 0.0;   // 元
+    int arrivalTolerance = 0;      // 分钟
+    int horizonDays = 1;           // 只乘坐出发日期起horizonDays天内起飞的航班
+};
+
+class ConnectionScan {
+public:
+    ConnectionScan();
+
+    // 建立连接数组，trips[i]是航班flights[i]按顺序的各航段，航段时间不是先后有序的航班不加入；
+    // 沿用调用方（航班图）已经分配好的城市和航班号编号，两边的编号一致
+    void build(const QVector<Flight>& flights, const QVector<QVector<Flight>>& trips,
+               NameTable cityTable, NameTable flightNumberTable);
+    void clear();
+
+    // 最短转机时间（分钟），默认为Constants::MIN_TRANSFER_TIME
+    void setMinimumConnectionTime(const QString& city, int minutes);
+    void setDefaultConnectionTime(int minutes);
+
+    // 在departAfter及以后出发、最早到达to的方案；maxTransfers >= 0时限制换乘次数，
+    // 经停不算换乘。到达不了时返回的方案没有航段
+    TransferPlan earliestArrival(const QString& from, const QString& to,
+                                 const QDateTime& departAfter, int maxTransfers = -1) const;
+
+    // date出发、在价格、到达时间和换乘次数上互不支配的全部方案，按到达时间升序
+    QVector<TransferPlan> paretoRoutes(const QString& from, const QString& to, const QDate& date,
+                                       const ParetoOptions& options = ParetoOptions()) const;
+
+    // from在date当天所有航班的起飞时间，升序且没有重复
+    QVector<QDateTime> departures(const QString& from, const QDate& date) const;
+
+    const NameTable& cityNames() const { return cities; }
+    const NameTable& flightNumberNames() const { return flightNumbers; }
+    int cityCount() const { return cities.size(); }
+    int connectionCount() const { return connections.size(); }
+
+private:
+    struct Connection {
+        int from;           // 城市编号
+        int to;
+        qint64 departure;   // 自1970年起的分钟数
+        qint64 arrival;
+        int trip;
+        int next;           // 同一行程下一个航段在数组中的下标，没有时为-1
+        int flight;         // 航班号编号
+        int airline;        // 航空公司编号
+        qint64 price;       // 分
+        qint64 tripPrice;   // 行程从第一段到本段（含）的价格之和（分）
+    };
+
+    int firstDepartureAfter(qint64 minutes) const;   // 第一个起飞时间不早于minutes的连接
+    Flight toFlight(const Connection& connection) const;
+    void appendRide(int board, int alight, TransferPlan& plan) const;
+    static bool inTimeOrder(const QVector<Flight>& legs);
+
+    QVector<Connection> connections;   // 按起飞时间升序
+    QVector<Flight> tripFlights;       // 各行程对应的原航班
+    QVector<int> tripStarts;           // 各行程第一个航段在数组中的下标
+    NameTable cities;
+    NameTable flightNumbers;
+    NameTable airlines;
+    QVector<int> connectionTimes;      // 各城市的最短转机时间
+    QHash<QString, int> customConnectionTimes;
+    int defaultConnectionTime;
+    int tripCount;
+    qint64 longestTrip;                // 行程第一段到最后一段起飞时间的最大间隔（分钟）
+};
+
+#endif // CONNECTIONSCAN_H
@@ -2,6 +2,7 @@
 #define DATA_H
 
 #include "common.h"
+#include "connectionpool.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -10,6 +11,8 @@
 #include <QDateTime>
 #include <QStringList>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QHash>
 #include <QDebug>
 
 // 航班信息结构体
@@ -115,6 +118,39 @@ struct TransferPlan {
     }
 };
 
+// 航班目录缓存：全部航班按起飞时间排序保存在内存中，
+// 按航班号和（出发城市, 到达城市, 日期）建立索引，城市或日期为空表示不限。
+// 查询只加读锁，不访问数据库；DatabaseManager写入数据库成功后同步更新缓存
+class FlightCache {
+public:
+    bool isLoaded() const;
+    void load(const QVector<Flight>& flights);
+    void invalidate();                  // 下次查询时重新从数据库加载
+    
+    QVector<Flight> allFlights() const;
+    QVector<Flight> search(const QString& from, const QString& to, const QDate& date) const;
+    bool find(const QString& flightNumber, Flight& result) const;
+    QVector<QString> cities() const;
+    
+    void insert(const Flight& flight);
+    void update(const Flight& flight);
+    void remove(const QString& flightNumber);
+    void setStatus(const QString& flightNumber, const QString& status);
+    void setTimes(const QString& flightNumber, const QDateTime& departure, const QDateTime& arrival);
+    void adjustSeats(const QString& flightNumber, int delta);
+    
+private:
+    static QString routeKey(const QString& from, const QString& to, const QDate& date);
+    void rebuild();                     // 重新排序并建立索引，调用前需持有写锁
+    
+    mutable QReadWriteLock lock;
+    bool loaded = false;
+    QVector<Flight> flights;            // 按起飞时间升序
+    QHash<QString, int> byNumber;       // 航班号 -> 下标
+    QHash<QString, QVector<int>> byRoute;   // routeKey -> 下标，按起飞时间升序
+    QVector<QString> cityList;          // 先出发城市后到达城市，按首次出现的顺序
+};
+
 // 数据库管理类
 class DatabaseManager {
 public:
@@ -191,12 +227,18 @@ private:
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
     
-    // 数据库连接
-    QSqlDatabase db;
-    static QMutex dbMutex;
+    // 数据库连接：每个线程使用连接池中自己的连接，读操作不加锁；
+    // 写操作（含写事务）持有writeMutex，同一时刻只有一个线程在写
+    ConnectionPool pool;
+    static QRecursiveMutex writeMutex;
+    
+    // 航班查询走缓存，缓存未加载时从数据库加载全部航班
+    FlightCache flightCache;
+    bool ensureFlightCache();
+    static Flight readFlight(const QSqlQuery& query);
     
     // 私有方法
-    bool executeQuery(QSqlQuery& query, const QString& errorMsg = QString());
+    bool executeQuery(PreparedQuery& query, const QString& errorMsg = QString());
     QString hashPassword(const QString& password);
     bool validateEmail(const QString& email);
     bool validatePhone(const QString& phone);
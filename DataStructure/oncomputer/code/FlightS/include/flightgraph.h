@@ -2,27 +2,19 @@
 #define FLIGHTGRAPH_H
 
 #include "data.h"
-#include <QMap>
-#include <QList>
-#include <QPair>
+#include "connectionscan.h"
+#include "nametable.h"
 #include <QString>
 #include <QVector>
 #include <QDateTime>
 
-// 航班边结构（图的边）
+// 航班边结构（图的边），城市和航班号用编号表示
 struct FlightEdge {
-    QString destination;    // 目标城市
-    QString flightNumber;   // 航班号
-    double price;          // 价格
-    QDateTime departureTime; // 起飞时间
-    QDateTime arrivalTime;  // 到达时间
-    
-    FlightEdge() : price(0.0) {}
-    
-    FlightEdge(const QString& dest, const QString& flight, double p, 
-               const QDateTime& dep, const QDateTime& arr)
-        : destination(dest), flightNumber(flight), price(p), 
-          departureTime(dep), arrivalTime(arr) {}
+    int destination;        // 目标城市编号
+    int flightNumber;       // 航班号编号
+    qint64 price;           // 价格（分）
+    qint64 departureTime;   // 起飞时间（自1970年起的分钟数）
+    qint64 arrivalTime;     // 到达时间
 };
 
 // 航班图类（用于转机推荐算法）
@@ -41,9 +33,15 @@ public:
     QVector<TransferPlan> findFastestRoutes(const QString& from, const QString& to, 
                                           const QDate& date, int maxTransfers = 2);
     
-    // 推荐系统
+    // 连接扫描：departAfter之后出发、最早到达的方案，maxTransfers < 0 时不限制换乘次数
+    TransferPlan findEarliestArrival(const QString& from, const QString& to,
+                                     const QDateTime& departAfter, int maxTransfers = -1) const;
+    void setMinimumConnectionTime(const QString& city, int minutes);
+    
+    // 推荐系统：价格、到达时间和换乘次数上互不支配的全部方案，按综合评分排序
     QVector<TransferPlan> recommendTransfers(const QString& from, const QString& to, 
                                            const QDate& date);
+    void setParetoOptions(const ParetoOptions& options);
     QVector<QString> findAlternativeDestinations(const QString& from, int maxPrice = -1);
     
     // 图信息
@@ -55,21 +53,22 @@ public:
     void printGraph() const;
 
 private:
-    // 邻接表：城市 -> 可达城市列表
-    QMap<QString, QList<FlightEdge>> adjacencyList;
+    // 压缩稀疏行（CSR）邻接表：城市i的出边为 edges[edgeOffsets[i]] 到 edges[edgeOffsets[i + 1] - 1]，
+    // 按起飞时间升序；城市编号按名称升序分配。
+    // 城市和航班号的编号表只有一份，保存在connectionScan中，与连接数组共用
+    QVector<int> edgeOffsets;
+    QVector<FlightEdge> edges;
+    
+    // 按起飞时间排序的航段连接，用于最早到达和多准则查询
+    ConnectionScan connectionScan;
     
-    // 私有算法方法
-    QVector<TransferPlan> dijkstraSearch(const QString& from, const QString& to, 
-                                       const QDate& date, bool byPrice = true);
-    void dfsSearch(const QString& current, const QString& target, const QDate& date,
-                   QVector<Flight>& currentPath, QVector<TransferPlan>& results,
-                   double currentPrice, QDateTime lastArrival, int maxTransfers);
+    // 多准则搜索的支配规则
+    ParetoOptions paretoOptions;
     
     // 工具方法
-    bool isValidConnection(const QDateTime& arrival, const QDateTime& departure) const;
-    double calculateTotalPrice(const QVector<Flight>& flights) const;
-    QDateTime calculateTotalTime(const QVector<Flight>& flights) const;
-    TransferPlan createTransferPlan(const QVector<Flight>& flights) const;
+    static QVector<Flight> splitLegs(const Flight& flight);
+    const NameTable& cities() const { return connectionScan.cityNames(); }
+    const NameTable& flightNumbers() const { return connectionScan.flightNumberNames(); }
 };
 
 #endif // FLIGHTGRAPH_H 
\ No newline at end of file
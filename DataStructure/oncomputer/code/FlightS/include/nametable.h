@@ -0,0 +1,27 @@
+#ifndef NAMETABLE_H
+#define NAMETABLE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// 名称编号表：把城市名、航班号等字符串映射为从0开始的连续编号，
+// 航班图和连接数组中只保存编号，输出时再换回名称
+class NameTable {
+public:
+    int intern(const QString& name);              // 已有时返回原来的编号
+    int id(const QString& name) const;            // 不存在时返回-1
+    const QString& name(int id) const { return names[id]; }
+    const QVector<QString>& allNames() const { return names; }
+    int size() const { return names.size(); }
+    void clear();
+
+    // 用一组名称（可以重复）重新建表，编号按名称升序分配
+    void assignSorted(QVector<QString> values);
+
+private:
+    QHash<QString, int> ids;
+    QVector<QString> names;
+};
+
+#endif // NAMETABLE_H
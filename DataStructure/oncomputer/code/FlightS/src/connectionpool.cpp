@@ -0,0 +1,153 @@
+#include "../include/connectionpool.h"
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDebug>
+
+PooledConnection::~PooledConnection() {
+    // 先释放语句和连接句柄，才能移除连接
+    qDeleteAll(statements);
+    statements.clear();
+    database.close();
+    database = QSqlDatabase();
+    // 程序退出时（单例析构）Qt的连接表可能已经销毁，此时只关闭不移除
+    if (QCoreApplication::instance()) {
+        QSqlDatabase::removeDatabase(name);
+    }
+}
+
+PreparedQuery::PreparedQuery(PooledConnection* owner, const QString& sql, QSqlQuery* query, bool reusable)
+    : owner(owner), sql(sql), query(query), reusable(reusable) {
+}
+
+PreparedQuery::PreparedQuery(PreparedQuery&& other) noexcept
+    : owner(other.owner), sql(other.sql), query(other.query), reusable(other.reusable), bound(other.bound) {
+    other.query = nullptr;
+}
+
+PreparedQuery& PreparedQuery::operator=(PreparedQuery&& other) noexcept {
+    if (this != &other) {
+        release();
+        owner = other.owner;
+        sql = other.sql;
+        query = other.query;
+        reusable = other.reusable;
+        bound = other.bound;
+        other.query = nullptr;
+    }
+    return *this;
+}
+
+PreparedQuery::~PreparedQuery() {
+    release();
+}
+
+bool PreparedQuery::exec() {
+    bound = 0;
+    return query->exec();
+}
+
+void PreparedQuery::release() {
+    if (!query) {
+        return;
+    }
+
+    // 结束结果集，否则连接会一直停留在这条语句开始时的读快照上
+    query->finish();
+    if (owner) {
+        owner->borrowed--;
+        if (reusable && !owner->statements.contains(sql)) {
+            owner->statements.insert(sql, query);
+            query = nullptr;
+            return;
+        }
+    }
+    delete query;
+    query = nullptr;
+}
+
+bool ConnectionPool::open(const QString& dbPath) {
+    {
+        QMutexLocker locker(&stateMutex);
+        path = dbPath;
+        generation++;
+    }
+    return connection().isOpen();
+}
+
+void ConnectionPool::close() {
+    {
+        QMutexLocker locker(&stateMutex);
+        path.clear();
+        generation++;
+    }
+    // 其他线程的连接在下次使用或线程结束时关闭
+    if (connections.hasLocalData() && connections.localData() && connections.localData()->borrowed == 0) {
+        connections.setLocalData(nullptr);
+    }
+}
+
+QSqlDatabase ConnectionPool::connection() {
+    PooledConnection* pooled = threadConnection();
+    return pooled ? pooled->database : QSqlDatabase();
+}
+
+PreparedQuery ConnectionPool::prepare(const QString& sql) {
+    PooledConnection* owner = threadConnection();
+    if (!owner) {
+        return PreparedQuery(nullptr, sql, new QSqlQuery(QSqlDatabase()), false);
+    }
+
+    bool reusable = true;
+    QSqlQuery* query = owner->statements.take(sql);
+    if (!query) {
+        query = new QSqlQuery(owner->database);
+        if (!query->prepare(sql)) {
+            qDebug() << "SQL预编译失败:" << query->lastError().text() << sql;
+            reusable = false;
+        }
+    }
+    owner->borrowed++;
+    return PreparedQuery(owner, sql, query, reusable);
+}
+
+PooledConnection* ConnectionPool::threadConnection() {
+    QString currentPath;
+    int currentGeneration;
+    {
+        QMutexLocker locker(&stateMutex);
+        currentPath = path;
+        currentGeneration = generation;
+    }
+
+    // 还有语句没归还时继续用旧连接，等这次操作结束后再重连
+    PooledConnection* pooled = connections.hasLocalData() ? connections.localData() : nullptr;
+    if (pooled && (pooled->generation == currentGeneration || pooled->borrowed > 0)) {
+        return pooled;
+    }
+    connections.setLocalData(nullptr);
+    if (currentPath.isEmpty()) {
+        return nullptr;
+    }
+
+    static QAtomicInt nextId;
+    pooled = new PooledConnection;
+    pooled->name = QString("FlightS_%1").arg(nextId.fetchAndAddRelaxed(1));
+    pooled->generation = currentGeneration;
+    connections.setLocalData(pooled);
+
+    pooled->database = QSqlDatabase::addDatabase("QSQLITE", pooled->name);
+    pooled->database.setDatabaseName(currentPath);
+    pooled->database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    if (!pooled->database.open()) {
+        qDebug() << "数据库连接失败:" << pooled->database.lastError().text();
+        return pooled;
+    }
+
+    // WAL模式下读不阻塞写，写也不阻塞读
+    QSqlQuery pragma(pooled->database);
+    if (!pragma.exec("PRAGMA journal_mode=WAL")) {
+        qDebug() << "启用WAL模式失败:" << pragma.lastError().text();
+    }
+    pragma.exec("PRAGMA synchronous=NORMAL");
+    return pooled;
+}
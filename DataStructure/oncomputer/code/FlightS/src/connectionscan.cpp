@@ -0,0 +1,423 @@
+#include "../include/connectionscan.h"
+#include <algorithm>
+#include <utility>
+#include <limits>
+
+namespace {
+    const qint64 UNREACHED = std::numeric_limits<qint64>::max() / 2;
+
+    // 城市在某个换乘次数下的最早到达：乘坐的最后一个行程从board上车、在alight下车，共乘坐legs个行程
+    struct Label {
+        qint64 arrival = UNREACHED;
+        int board = -1;
+        int alight = -1;
+        int legs = 0;
+    };
+
+    // 行程在本次扫描中的状态：legs为0表示还赶不上，否则为乘上它时共乘坐的行程数
+    struct TripState {
+        int legs = 0;
+        int board = -1;
+    };
+
+    // 多准则标号：到达城市的时间、累计价格和乘坐的行程数；
+    // 最后一个行程从board上车、在alight下车，parent为上车前所在城市的标号
+    struct ParetoLabel {
+        qint64 arrival;
+        qint64 price;
+        int rides;
+        int board;
+        int alight;
+        int parent;
+    };
+
+    // 行程上的标号：price为上车前的累计价格减去行程中上车点之前各段的价格，
+    // 乘到某一段时的累计价格为 price + 该段的tripPrice，同一行程上不同上车点的标号可以直接比较
+    struct RideLabel {
+        qint64 price;
+        int rides;
+        int board;
+        int parent;
+    };
+}
+
+ConnectionScan::ConnectionScan()
+    : defaultConnectionTime(Constants::MIN_TRANSFER_TIME), tripCount(0), longestTrip(0) {
+}
+
+void ConnectionScan::build(const QVector<Flight>& flights, const QVector<QVector<Flight>>& trips,
+                           NameTable cityTable, NameTable flightNumberTable) {
+    clear();
+    cities = std::move(cityTable);
+    flightNumbers = std::move(flightNumberTable);
+
+    // 先按建表顺序写出连接，next为建表顺序中的下标
+    QVector<Connection> unsorted;
+    QVector<int> firstLegs;
+    for (int t = 0; t < trips.size(); ++t) {
+        // 扫描依赖同一行程的航段先后有序，时间错乱的航班无法乘坐
+        const QVector<Flight>& trip = trips[t];
+        if (trip.isEmpty() || !inTimeOrder(trip)) {
+            continue;
+        }
+        tripFlights.append(flights[t]);
+        firstLegs.append(unsorted.size());
+        longestTrip = qMax(longestTrip, Timetable::toMinutes(trip.last().departureTime)
+                                        - Timetable::toMinutes(trip.first().departureTime));
+        qint64 tripPrice = 0;
+        for (int k = 0; k < trip.size(); ++k) {
+            const Flight& flight = trip[k];
+            Connection connection;
+            connection.from = cities.intern(flight.departureCity);
+            connection.to = cities.intern(flight.arrivalCity);
+            connection.departure = Timetable::toMinutes(flight.departureTime);
+            connection.arrival = Timetable::toMinutes(flight.arrivalTime);
+            connection.trip = tripCount;
+            connection.next = k + 1 < trip.size() ? unsorted.size() + 1 : -1;
+            connection.flight = flightNumbers.intern(flight.flightNumber);
+            connection.airline = airlines.intern(flight.airline);
+            connection.price = Timetable::toCents(flight.price);
+            if (k + 1 == trip.size()) {
+                // 平分票价的舍入误差计入最后一段，全程乘坐的价格与原航班票价相同
+                connection.price = Timetable::toCents(flights[t].price) - tripPrice;
+            }
+            tripPrice += connection.price;
+            connection.tripPrice = tripPrice;
+            unsorted.append(connection);
+        }
+        tripCount++;
+    }
+
+    // 按起飞时间排序，同一行程的航段先后顺序不变，再把next换成排序后的下标
+    QVector<int> order(unsorted.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&unsorted](int a, int b) {
+        return unsorted[a].departure < unsorted[b].departure;
+    });
+    QVector<int> positions(order.size());
+    for (int i = 0; i < order.size(); ++i) {
+        positions[order[i]] = i;
+    }
+    connections.reserve(order.size());
+    for (int index : order) {
+        Connection connection = unsorted[index];
+        if (connection.next >= 0) {
+            connection.next = positions[connection.next];
+        }
+        connections.append(connection);
+    }
+    tripStarts.reserve(firstLegs.size());
+    for (int first : firstLegs) {
+        tripStarts.append(positions[first]);
+    }
+
+    connectionTimes.fill(defaultConnectionTime, cities.size());
+    for (auto it = customConnectionTimes.constBegin(); it != customConnectionTimes.constEnd(); ++it) {
+        int id = cities.id(it.key());
+        if (id >= 0) {
+            connectionTimes[id] = it.value();
+        }
+    }
+}
+
+void ConnectionScan::clear() {
+    connections.clear();
+    tripFlights.clear();
+    tripStarts.clear();
+    cities.clear();
+    flightNumbers.clear();
+    airlines.clear();
+    connectionTimes.clear();
+    tripCount = 0;
+    longestTrip = 0;
+}
+
+void ConnectionScan::setMinimumConnectionTime(const QString& city, int minutes) {
+    customConnectionTimes[city] = minutes;
+    int id = cities.id(city);
+    if (id >= 0) {
+        connectionTimes[id] = minutes;
+    }
+}
+
+void ConnectionScan::setDefaultConnectionTime(int minutes) {
+    defaultConnectionTime = minutes;
+    for (int id = 0; id < cities.size(); ++id) {
+        connectionTimes[id] = customConnectionTimes.value(cities.name(id), minutes);
+    }
+}
+
+TransferPlan ConnectionScan::earliestArrival(const QString& from, const QString& to,
+                                             const QDateTime& departAfter, int maxTransfers) const {
+    TransferPlan plan;
+    const int source = cities.id(from);
+    const int target = cities.id(to);
+    if (source < 0 || target < 0 || source == target || !departAfter.isValid()) {
+        return plan;
+    }
+
+    // 不限制换乘时每个城市只有一个标号；限制时第k个标号是最多乘坐k个行程的最早到达，
+    // 随k单调不增，上车时取满足转机时间的最小k，乘坐的行程数最少
+    const bool bounded = maxTransfers >= 0;
+    const int maxLegs = bounded ? maxTransfers + 1 : std::numeric_limits<int>::max();
+    const int slotCount = bounded ? maxLegs + 1 : 1;
+    const int width = cities.size();
+    QVector<Label> labels(slotCount * width);
+    auto label = [&labels, width](int slot, int city) -> Label& {
+        return labels[slot * width + city];
+    };
+    const qint64 start = Timetable::toMinutes(departAfter);
+    for (int slot = 0; slot < slotCount; ++slot) {
+        label(slot, source).arrival = start;
+    }
+    QVector<TripState> trips(tripCount);
+
+    for (int i = firstDepartureAfter(start); i < connections.size(); ++i) {
+        const Connection& connection = connections[i];
+        // 之后的连接起飞时已经不可能更早到达目的地
+        if (connection.departure >= label(slotCount - 1, target).arrival) {
+            break;
+        }
+
+        // 在出发城市不需要转机时间
+        TripState& trip = trips[connection.trip];
+        const qint64 transfer = connection.from == source ? 0 : connectionTimes[connection.from];
+        const int lastSlot = bounded ? maxLegs - 1 : 0;
+        for (int slot = 0; slot <= lastSlot; ++slot) {
+            const Label& at = label(slot, connection.from);
+            if (at.arrival + transfer <= connection.departure) {
+                int boardLegs = bounded ? slot + 1 : at.legs + 1;
+                if (trip.legs == 0 || boardLegs < trip.legs) {
+                    trip.legs = boardLegs;
+                    trip.board = i;
+                }
+                break;
+            }
+        }
+        if (trip.legs == 0) {
+            continue;
+        }
+
+        for (int slot = bounded ? trip.legs : 0; slot < slotCount; ++slot) {
+            Label& at = label(slot, connection.to);
+            if (connection.arrival < at.arrival) {
+                at.arrival = connection.arrival;
+                at.board = trip.board;
+                at.alight = i;
+                at.legs = trip.legs;
+            }
+        }
+    }
+
+    if (label(slotCount - 1, target).arrival >= UNREACHED) {
+        return plan;
+    }
+
+    // 从目的地沿标号倒推：每个标号对应一个行程中从上车到下车的各航段
+    QVector<const Label*> rides;
+    int city = target;
+    int slot = slotCount - 1;
+    while (city != source) {
+        const Label& at = label(slot, city);
+        rides.append(&at);
+        city = connections[at.board].from;
+        slot = bounded ? at.legs - 1 : 0;
+    }
+    for (int i = rides.size() - 1; i >= 0; --i) {
+        appendRide(rides[i]->board, rides[i]->alight, plan);
+    }
+    plan.transferCount = rides.size() - 1;
+    return plan;
+}
+
+QVector<TransferPlan> ConnectionScan::paretoRoutes(const QString& from, const QString& to, const QDate& date,
+                                                   const ParetoOptions& options) const {
+    QVector<TransferPlan> result;
+    const int source = cities.id(from);
+    const int target = cities.id(to);
+    if (source < 0 || target < 0 || source == target || !date.isValid()) {
+        return result;
+    }
+
+    const qint64 start = Timetable::toMinutes(date.startOfDay());
+    const qint64 end = Timetable::toMinutes(date.addDays(qMax(1, options.horizonDays)).startOfDay());
+    const qint64 priceTolerance = Timetable::toCents(options.priceTolerance);
+    const int maxRides = options.maxTransfers >= 0 ? options.maxTransfers + 1 : std::numeric_limits<int>::max();
+
+    // 标号只追加到pool中，各城市的bag保存当前互不支配的标号在pool中的下标
+    QVector<ParetoLabel> pool;
+    QVector<QVector<int>> bags(cities.size());
+    QVector<QVector<RideLabel>> trips(tripCount);
+    ParetoLabel origin = { start, 0, 0, -1, -1, -1 };
+    pool.append(origin);
+    bags[source].append(0);
+
+    // a在三项上都不差于b（到达时间和价格允许容差）
+    auto covers = [&options, priceTolerance](const ParetoLabel& a, qint64 arrival, qint64 price, int rides) {
+        return a.arrival <= arrival + options.arrivalTolerance
+               && a.price <= price + priceTolerance
+               && a.rides <= rides;
+    };
+
+    // 范围之后起飞的航段不能再上车，但已经乘上的航班可以继续乘到终点
+    const qint64 last = end + longestTrip;
+    const QVector<int> noLabels;
+    for (int i = firstDepartureAfter(start); i < connections.size() && connections[i].departure < last; ++i) {
+        const Connection& connection = connections[i];
+        QVector<RideLabel>& onboard = trips[connection.trip];
+
+        // 用出发城市中赶得上的标号上车；在出发城市不需要转机时间
+        const qint64 transfer = connection.from == source ? 0 : connectionTimes[connection.from];
+        const qint64 before = connection.tripPrice - connection.price;
+        const QVector<int>& boardable = connection.departure < end ? bags[connection.from] : noLabels;
+        for (int index : boardable) {
+            const ParetoLabel& at = pool[index];
+            if (at.arrival + transfer > connection.departure || at.rides >= maxRides) {
+                continue;
+            }
+            RideLabel ride = { at.price - before, at.rides + 1, i, index };
+            bool dominated = false;
+            for (const RideLabel& other : onboard) {
+                if (other.price <= ride.price && other.rides <= ride.rides) {
+                    dominated = true;
+                    break;
+                }
+            }
+            if (dominated) {
+                continue;
+            }
+            for (int k = onboard.size() - 1; k >= 0; --k) {
+                if (ride.price <= onboard[k].price && ride.rides <= onboard[k].rides) {
+                    onboard.remove(k);
+                }
+            }
+            onboard.append(ride);
+        }
+
+        // 乘到到达城市下车；被目的地已有方案支配的标号不可能再改进结果，直接舍弃
+        for (const RideLabel& ride : onboard) {
+            const qint64 price = ride.price + connection.tripPrice;
+            bool dominated = false;
+            for (int index : bags[target]) {
+                dominated = dominated || covers(pool[index], connection.arrival, price, ride.rides);
+            }
+            QVector<int>& bag = bags[connection.to];
+            if (connection.to != target) {
+                for (int index : bag) {
+                    dominated = dominated || covers(pool[index], connection.arrival, price, ride.rides);
+                }
+            }
+            if (dominated) {
+                continue;
+            }
+
+            ParetoLabel label = { connection.arrival, price, ride.rides, ride.board, i, ride.parent };
+            for (int k = bag.size() - 1; k >= 0; --k) {
+                const ParetoLabel& other = pool[bag[k]];
+                if (label.arrival <= other.arrival && label.price <= other.price && label.rides <= other.rides) {
+                    bag.remove(k);
+                }
+            }
+            bag.append(pool.size());
+            pool.append(label);
+        }
+    }
+
+    // 沿parent倒推出各方案的航段
+    for (int index : bags[target]) {
+        QVector<int> chain;
+        for (int k = index; pool[k].parent >= 0; k = pool[k].parent) {
+            chain.append(k);
+        }
+        TransferPlan plan;
+        for (int k = chain.size() - 1; k >= 0; --k) {
+            appendRide(pool[chain[k]].board, pool[chain[k]].alight, plan);
+        }
+        plan.transferCount = chain.size() - 1;
+        result.append(plan);
+    }
+    std::sort(result.begin(), result.end(), [](const TransferPlan& a, const TransferPlan& b) {
+        if (a.arrivalTime != b.arrivalTime) {
+            return a.arrivalTime < b.arrivalTime;
+        }
+        return a.totalPrice < b.totalPrice;
+    });
+    return result;
+}
+
+void ConnectionScan::appendRide(int board, int alight, TransferPlan& plan) const {
+    // 从始发地乘到终点就是乘坐整个航班，返回原航班（真实的航班号、时间和票价）而不是拆出的航段
+    const int trip = connections[board].trip;
+    if (board == tripStarts[trip] && connections[alight].next < 0) {
+        const Flight& flight = tripFlights[trip];
+        plan.flights.append(flight);
+        plan.totalPrice += flight.price;
+    } else {
+        for (int j = board; j >= 0; j = connections[j].next) {
+            const Flight leg = toFlight(connections[j]);
+            plan.flights.append(leg);
+            plan.totalPrice += leg.price;
+            if (j == alight) {
+                break;
+            }
+        }
+    }
+    if (!plan.flights.isEmpty()) {
+        plan.departureTime = plan.flights.first().departureTime;
+        plan.arrivalTime = plan.flights.last().arrivalTime;
+    }
+}
+
+QVector<QDateTime> ConnectionScan::departures(const QString& from, const QDate& date) const {
+    QVector<QDateTime> result;
+    const int source = cities.id(from);
+    if (source < 0 || !date.isValid()) {
+        return result;
+    }
+
+    const qint64 dayStart = Timetable::toMinutes(date.startOfDay());
+    const qint64 dayEnd = Timetable::toMinutes(date.addDays(1).startOfDay());
+    qint64 previous = -1;
+    for (int i = firstDepartureAfter(dayStart); i < connections.size() && connections[i].departure < dayEnd; ++i) {
+        const Connection& connection = connections[i];
+        if (connection.from == source && connection.departure != previous) {
+            result.append(Timetable::fromMinutes(connection.departure));
+            previous = connection.departure;
+        }
+    }
+    return result;
+}
+
+bool ConnectionScan::inTimeOrder(const QVector<Flight>& legs) {
+    for (int k = 0; k < legs.size(); ++k) {
+        const qint64 departure = Timetable::toMinutes(legs[k].departureTime);
+        if (Timetable::toMinutes(legs[k].arrivalTime) < departure
+            || (k > 0 && departure < Timetable::toMinutes(legs[k - 1].arrivalTime))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int ConnectionScan::firstDepartureAfter(qint64 minutes) const {
+    auto it = std::lower_bound(connections.begin(), connections.end(), minutes,
+                               [](const Connection& connection, qint64 value) {
+        return connection.departure < value;
+    });
+    return static_cast<int>(it - connections.begin());
+}
+
+Flight ConnectionScan::toFlight(const Connection& connection) const {
+    Flight flight;
+    flight.flightNumber = flightNumbers.name(connection.flight);
+    flight.airline = airlines.name(connection.airline);
+    flight.departureCity = cities.name(connection.from);
+    flight.arrivalCity = cities.name(connection.to);
+    flight.departureTime = Timetable::fromMinutes(connection.departure);
+    flight.arrivalTime = Timetable::fromMinutes(connection.arrival);
+    flight.price = Timetable::fromCents(connection.price);
+    flight.status = Constants::FLIGHT_SCHEDULED;
+    return flight;
+}
@@ -1,14 +1,182 @@
 #include "data.h"
 #include <QCryptographicHash>
 #include <QRegularExpression>
-#include <QSqlRecord>
 #include <QVariant>
 #include <QDir>
 #include <QCoreApplication>
 #include <QSet>
+#include <algorithm>
 
 // 静态成员初始化
-QMutex DatabaseManager::dbMutex;
+QRecursiveMutex DatabaseManager::writeMutex;
+
+// 航班目录缓存实现
+bool FlightCache::isLoaded() const {
+    QReadLocker locker(&lock);
+    return loaded;
+}
+
+void FlightCache::load(const QVector<Flight>& catalogue) {
+    QWriteLocker locker(&lock);
+    flights = catalogue;
+    loaded = true;
+    rebuild();
+}
+
+void FlightCache::invalidate() {
+    QWriteLocker locker(&lock);
+    loaded = false;
+    flights.clear();
+    byNumber.clear();
+    byRoute.clear();
+    cityList.clear();
+}
+
+QVector<Flight> FlightCache::allFlights() const {
+    QReadLocker locker(&lock);
+    return flights;
+}
+
+QVector<Flight> FlightCache::search(const QString& from, const QString& to, const QDate& date) const {
+    QReadLocker locker(&lock);
+    QVector<Flight> result;
+    auto it = byRoute.constFind(routeKey(from, to, date));
+    if (it != byRoute.constEnd()) {
+        result.reserve(it.value().size());
+        for (int index : it.value()) {
+            result.append(flights[index]);
+        }
+    }
+    return result;
+}
+
+bool FlightCache::find(const QString& flightNumber, Flight& result) const {
+    QReadLocker locker(&lock);
+    auto it = byNumber.constFind(flightNumber);
+    if (it == byNumber.constEnd()) {
+        return false;
+    }
+    result = flights[it.value()];
+    return true;
+}
+
+QVector<QString> FlightCache::cities() const {
+    QReadLocker locker(&lock);
+    return cityList;
+}
+
+void FlightCache::insert(const Flight& flight) {
+    QWriteLocker locker(&lock);
+    if (!loaded) {
+        return;
+    }
+    flights.append(flight);
+    rebuild();
+}
+
+void FlightCache::update(const Flight& flight) {
+    QWriteLocker locker(&lock);
+    auto it = byNumber.constFind(flight.flightNumber);
+    if (it == byNumber.constEnd()) {
+        return;
+    }
+    Flight& cached = flights[it.value()];
+    bool moved = cached.departureCity != flight.departureCity ||
+                 cached.arrivalCity != flight.arrivalCity ||
+                 cached.departureTime != flight.departureTime;
+    cached = flight;
+    // 城市或起飞时间变化时索引位置也变了
+    if (moved) {
+        rebuild();
+    }
+}
+
+void FlightCache::remove(const QString& flightNumber) {
+    QWriteLocker locker(&lock);
+    auto it = byNumber.constFind(flightNumber);
+    if (it == byNumber.constEnd()) {
+        return;
+    }
+    flights.removeAt(it.value());
+    rebuild();
+}
+
+void FlightCache::setStatus(const QString& flightNumber, const QString& status) {
+    QWriteLocker locker(&lock);
+    auto it = byNumber.constFind(flightNumber);
+    if (it != byNumber.constEnd()) {
+        flights[it.value()].status = status;
+    }
+}
+
+void FlightCache::setTimes(const QString& flightNumber, const QDateTime& departure, const QDateTime& arrival) {
+    QWriteLocker locker(&lock);
+    auto it = byNumber.constFind(flightNumber);
+    if (it == byNumber.constEnd()) {
+        return;
+    }
+    flights[it.value()].departureTime = departure;
+    flights[it.value()].arrivalTime = arrival;
+    rebuild();
+}
+
+void FlightCache::adjustSeats(const QString& flightNumber, int delta) {
+    QWriteLocker locker(&lock);
+    auto it = byNumber.constFind(flightNumber);
+    if (it != byNumber.constEnd()) {
+        flights[it.value()].availableSeats += delta;
+    }
+}
+
+QString FlightCache::routeKey(const QString& from, const QString& to, const QDate& date) {
+    return from + QChar('\n') + to + QChar('\n') +
+           (date.isValid() ? date.toString("yyyy-MM-dd") : QString());
+}
+
+void FlightCache::rebuild() {
+    std::stable_sort(flights.begin(), flights.end(), [](const Flight& a, const Flight& b) {
+        return a.departureTime < b.departureTime;
+    });
+    
+    byNumber.clear();
+    byRoute.clear();
+    cityList.clear();
+    byNumber.reserve(flights.size());
+    
+    // 每个航班登记到出发城市、到达城市和日期分别为具体值或不限的8个组合下，
+    // 任意查询条件都只需一次哈希查找
+    QSet<QString> seen;
+    QVector<QString> arrivals;
+    for (int i = 0; i < flights.size(); ++i) {
+        const Flight& flight = flights[i];
+        byNumber.insert(flight.flightNumber, i);
+        
+        const QString froms[] = { flight.departureCity, QString() };
+        const QString tos[] = { flight.arrivalCity, QString() };
+        const QDate dates[] = { flight.departureTime.date(), QDate() };
+        for (const QString& from : froms) {
+            for (const QString& to : tos) {
+                for (const QDate& date : dates) {
+                    byRoute[routeKey(from, to, date)].append(i);
+                }
+            }
+        }
+        
+        if (!flight.departureCity.isEmpty() && !seen.contains(flight.departureCity)) {
+            seen.insert(flight.departureCity);
+            cityList.append(flight.departureCity);
+        }
+        if (!flight.arrivalCity.isEmpty()) {
+            arrivals.append(flight.arrivalCity);
+        }
+    }
+    for (const QString& city : arrivals) {
+        if (!seen.contains(city)) {
+            seen.insert(city);
+            cityList.append(city);
+        }
+    }
+}
 
 DatabaseManager& DatabaseManager::instance() {
     static DatabaseManager instance;
@@ -20,19 +188,12 @@ DatabaseManager::~DatabaseManager() {
 }
 
 bool DatabaseManager::connectToDatabase(const QString& dbPath) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
-    // 如果已经连接，先关闭
-    if (db.isOpen()) {
-        db.close();
-    }
-    
-    // 创建数据库连接
-    db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName(dbPath);
+    flightCache.invalidate();
     
-    if (!db.open()) {
-        qDebug() << "数据库连接失败:" << db.lastError().text();
+    // 各线程的已有连接在下次使用时重连到新的数据库
+    if (!pool.open(dbPath)) {
         return false;
     }
     
@@ -41,16 +202,15 @@ bool DatabaseManager::connectToDatabase(const QString& dbPath) {
 }
 
 void DatabaseManager::closeDatabase() {
-    QMutexLocker locker(&dbMutex);
-    if (db.isOpen()) {
-        db.close();
-        qDebug() << "数据库连接已关闭";
-    }
+    QMutexLocker locker(&writeMutex);
+    flightCache.invalidate();
+    pool.close();
+    qDebug() << "数据库连接已关闭";
 }
 
 
 
-bool DatabaseManager::executeQuery(QSqlQuery& query, const QString& errorMsg) {
+bool DatabaseManager::executeQuery(PreparedQuery& query, const QString& errorMsg) {
     if (!query.exec()) {
         qDebug() << errorMsg << query.lastError().text();
         return false;
@@ -77,7 +237,7 @@ bool DatabaseManager::validatePhone(const QString& phone) {
 bool DatabaseManager::registerUser(const QString& username, const QString& password, 
                                   const QString& email, const QString& phone, 
                                   const QString& userType) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     // 验证输入
     if (username.isEmpty() || password.isEmpty()) {
@@ -95,9 +255,8 @@ bool DatabaseManager::registerUser(const QString& username, const QString& passw
         return false;
     }
     
-    QSqlQuery query(db);
-    query.prepare("INSERT INTO user (username, password, email, phone, user_type) "
-                  "VALUES (?, ?, ?, ?, ?)");
+    PreparedQuery query = pool.prepare("INSERT INTO user (username, password, email, phone, user_type) "
+                                       "VALUES (?, ?, ?, ?, ?)");
     query.addBindValue(username);
     query.addBindValue(password); // 直接使用明文密码
     query.addBindValue(email);
@@ -113,11 +272,10 @@ bool DatabaseManager::registerUser(const QString& username, const QString& passw
 }
 
 int DatabaseManager::authenticateUser(const QString& username, const QString& password) {
-    QMutexLocker locker(&dbMutex);
-    
     qDebug() << "尝试用户登录:" << username << "密码:" << password;
     
     // 检查数据库连接
+    QSqlDatabase db = pool.connection();
     if (!db.isOpen()) {
         qDebug() << "数据库未连接";
         return -1;
@@ -154,12 +312,9 @@ int DatabaseManager::authenticateUser(const QString& username, const QString& pa
 }
 
 User DatabaseManager::getUserInfo(int userId) {
-    QMutexLocker locker(&dbMutex);
-    
     User user;
-    QSqlQuery query(db);
-    query.prepare("SELECT user_id, username, password, email, phone, user_type "
-                  "FROM user WHERE user_id = ?");
+    PreparedQuery query = pool.prepare("SELECT user_id, username, password, email, phone, user_type "
+                                       "FROM user WHERE user_id = ?");
     query.addBindValue(userId);
     
     if (query.exec() && query.next()) {
@@ -177,11 +332,10 @@ User DatabaseManager::getUserInfo(int userId) {
 }
 
 bool DatabaseManager::updateUserInfo(const User& user) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
-    QSqlQuery query(db);
-    query.prepare("UPDATE user SET username = ?, email = ?, phone = ?, user_type = ? "
-                  "WHERE user_id = ?");
+    PreparedQuery query = pool.prepare("UPDATE user SET username = ?, email = ?, phone = ?, user_type = ? "
+                                       "WHERE user_id = ?");
     query.addBindValue(user.username);
     query.addBindValue(user.email);
     query.addBindValue(user.phone);
@@ -193,11 +347,10 @@ bool DatabaseManager::updateUserInfo(const User& user) {
 
 // 管理员相关操作实现
 int DatabaseManager::authenticateManager(const QString& username, const QString& password) {
-    QMutexLocker locker(&dbMutex);
-    
     qDebug() << "尝试管理员登录:" << username << "密码:" << password;
     
     // 检查数据库连接
+    QSqlDatabase db = pool.connection();
     if (!db.isOpen()) {
         qDebug() << "数据库未连接";
         return -1;
@@ -234,11 +387,8 @@ int DatabaseManager::authenticateManager(const QString& username, const QString&
 }
 
 Manager DatabaseManager::getManagerInfo(int managerId) {
-    QMutexLocker locker(&dbMutex);
-    
     Manager manager;
-    QSqlQuery query(db);
-    query.prepare("SELECT manager_id, username, password FROM manager WHERE manager_id = ?");
+    PreparedQuery query = pool.prepare("SELECT manager_id, username, password FROM manager WHERE manager_id = ?");
     query.addBindValue(managerId);
     
     if (executeQuery(query, "获取管理员信息失败:") && query.next()) {
@@ -251,123 +401,68 @@ Manager DatabaseManager::getManagerInfo(int managerId) {
 }
 
 // 航班相关操作实现
-QVector<Flight> DatabaseManager::getAllFlights() {
-    QMutexLocker locker(&dbMutex);
-    QVector<Flight> flights;
-    
-    QSqlQuery query(db);
-    // 先查询表结构以确认字段名
-    if (query.exec("PRAGMA table_info(flight)")) {
-        qDebug() << "flight表结构:";
-        while (query.next()) {
-            qDebug() << "字段:" << query.value(1).toString() << "类型:" << query.value(2).toString();
-        }
+Flight DatabaseManager::readFlight(const QSqlQuery& query) {
+    Flight flight;
+    flight.flightNumber = query.value("flight_number").toString();
+    flight.airline = query.value("airline").toString();
+    flight.departureCity = query.value("departure_city").toString();
+    flight.arrivalCity = query.value("arrival_city").toString();
+    flight.departureTime = query.value("departure_time").toDateTime();
+    flight.arrivalTime = query.value("arrival_time").toDateTime();
+    
+    QString stopover = query.value("stopover").toString();
+    if (!stopover.isEmpty()) {
+        flight.stopovers = stopover.split(",");
+    }
+    
+    flight.totalSeats = query.value("total_seats").toInt();
+    flight.availableSeats = query.value("available_seats").toInt();
+    flight.price = query.value("price").toDouble();
+    flight.status = query.value("status").toString();
+    return flight;
+}
+
+bool DatabaseManager::ensureFlightCache() {
+    if (flightCache.isLoaded()) {
+        return true;
     }
     
-    // 使用基本的SELECT查询，让数据库告诉我们实际有哪些字段
-    if (query.exec("SELECT * FROM flight LIMIT 1")) {
-        QSqlRecord record = query.record();
-        qDebug() << "flight表字段数量:" << record.count();
-        for (int i = 0; i < record.count(); ++i) {
-            qDebug() << "字段" << i << ":" << record.fieldName(i);
-        }
+    QMutexLocker locker(&writeMutex);
+    // 等锁期间可能已被其他线程加载
+    if (flightCache.isLoaded()) {
+        return true;
     }
     
-    // 现在尝试查询所有航班数据
-    if (query.exec("SELECT * FROM flight ORDER BY departure_time")) {
-        while (query.next()) {
-            Flight flight;
-            QSqlRecord record = query.record();
-            
-            // 安全地获取字段值
-            flight.flightNumber = query.value("flight_number").toString();
-            flight.airline = query.value("airline").toString();
-            flight.departureCity = query.value("departure_city").toString();
-            flight.arrivalCity = query.value("arrival_city").toString();
-            flight.departureTime = query.value("departure_time").toDateTime();
-            flight.arrivalTime = query.value("arrival_time").toDateTime();
-            
-            QString stopover = query.value("stopover").toString();
-            if (!stopover.isEmpty()) {
-                flight.stopovers = stopover.split(",");
-            }
-            
-            flight.totalSeats = query.value("total_seats").toInt();
-            flight.availableSeats = query.value("available_seats").toInt();
-            flight.price = query.value("price").toDouble();
-            flight.status = query.value("status").toString();
-            
-            flights.append(flight);
-        }
-    } else {
+    QVector<Flight> flights;
+    QSqlQuery query(pool.connection());
+    if (!query.exec("SELECT * FROM flight ORDER BY departure_time")) {
         qDebug() << "查询flight表失败:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        flights.append(readFlight(query));
     }
     
-    qDebug() << "获取航班数据:" << flights.size() << "条记录";
-    return flights;
+    flightCache.load(flights);
+    qDebug() << "航班缓存已加载:" << flights.size() << "条记录";
+    return true;
 }
 
-QVector<Flight> DatabaseManager::searchFlights(const QString& from, const QString& to, const QDate& date) {
-    QMutexLocker locker(&dbMutex);
-    QVector<Flight> flights;
-    
-    QSqlQuery query(db);
-    QString sql = "SELECT * FROM flight WHERE 1=1";
-    
-    QStringList conditions;
-    QVariantList values;
-    
-    if (!from.isEmpty() && from != "不限") {
-        conditions << "departure_city = ?";
-        values << from;
-    }
-    
-    if (!to.isEmpty() && to != "不限") {
-        conditions << "arrival_city = ?";
-        values << to;
-    }
-    
-    if (date.isValid()) {
-        conditions << "DATE(departure_time) = ?";
-        values << date.toString("yyyy-MM-dd");
+QVector<Flight> DatabaseManager::getAllFlights() {
+    if (!ensureFlightCache()) {
+        return QVector<Flight>();
     }
-    
-    if (!conditions.isEmpty()) {
-        sql += " AND " + conditions.join(" AND ");
+    return flightCache.allFlights();
+}
+
+QVector<Flight> DatabaseManager::searchFlights(const QString& from, const QString& to, const QDate& date) {
+    if (!ensureFlightCache()) {
+        return QVector<Flight>();
     }
     
-    sql += " ORDER BY departure_time";
-    
-    query.prepare(sql);
-    for (const QVariant& value : values) {
-        query.addBindValue(value);
-    }
-    
-    if (query.exec()) {
-        while (query.next()) {
-            Flight flight;
-            flight.flightNumber = query.value("flight_number").toString();
-            flight.airline = query.value("airline").toString();
-            flight.departureCity = query.value("departure_city").toString();
-            flight.arrivalCity = query.value("arrival_city").toString();
-            flight.departureTime = query.value("departure_time").toDateTime();
-            flight.arrivalTime = query.value("arrival_time").toDateTime();
-            
-            QString stopover = query.value("stopover").toString();
-            if (!stopover.isEmpty()) {
-                flight.stopovers = stopover.split(",");
-            }
-            
-            flight.totalSeats = query.value("total_seats").toInt();
-            flight.availableSeats = query.value("available_seats").toInt();
-            flight.price = query.value("price").toDouble();
-            flight.status = query.value("status").toString();
-            
-            flights.append(flight);
-        }
-    } else {
-        qDebug() << "航班搜索失败:" << query.lastError().text();
-    }
+    QVector<Flight> flights = flightCache.search(from == "不限" ? QString() : from,
+                                                 to == "不限" ? QString() : to,
+                                                 date);
     
     qDebug() << QString("搜索航班: %1->%2 日期:%3, 找到%4条记录")
                 .arg(from, to, date.toString(), QString::number(flights.size()));
@@ -375,7 +470,6 @@ QVector<Flight> DatabaseManager::searchFlights(const QString& from, const QStrin
 }
 
 Flight DatabaseManager::getFlight(const QString& flightNumber) {
-    QMutexLocker locker(&dbMutex);
     Flight flight;
     
     if (flightNumber.isEmpty()) {
@@ -383,36 +477,15 @@ Flight DatabaseManager::getFlight(const QString& flightNumber) {
         return flight;
     }
     
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM flight WHERE flight_number = ?");
-    query.addBindValue(flightNumber);
-    
-    if (query.exec() && query.next()) {
-        flight.flightNumber = query.value("flight_number").toString();
-        flight.airline = query.value("airline").toString();
-        flight.departureCity = query.value("departure_city").toString();
-        flight.arrivalCity = query.value("arrival_city").toString();
-        flight.departureTime = query.value("departure_time").toDateTime();
-        flight.arrivalTime = query.value("arrival_time").toDateTime();
-        
-        QString stopover = query.value("stopover").toString();
-        if (!stopover.isEmpty()) {
-            flight.stopovers = stopover.split(",");
-        }
-        
-        flight.totalSeats = query.value("total_seats").toInt();
-        flight.availableSeats = query.value("available_seats").toInt();
-        flight.price = query.value("price").toDouble();
-        flight.status = query.value("status").toString();
-    } else {
-        qDebug() << "获取航班信息失败:" << flightNumber << query.lastError().text();
+    if (!ensureFlightCache() || !flightCache.find(flightNumber, flight)) {
+        qDebug() << "获取航班信息失败:" << flightNumber;
     }
     
     return flight;
 }
 
 bool DatabaseManager::addFlight(const Flight& flight) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     // 验证航班信息
     if (!flight.isValid()) {
@@ -421,8 +494,7 @@ bool DatabaseManager::addFlight(const Flight& flight) {
     }
     
     // 检查航班号是否已存在
-    QSqlQuery checkQuery(db);
-    checkQuery.prepare("SELECT COUNT(*) FROM flight WHERE flight_number = ?");
+    PreparedQuery checkQuery = pool.prepare("SELECT COUNT(*) FROM flight WHERE flight_number = ?");
     checkQuery.addBindValue(flight.flightNumber);
     
     if (checkQuery.exec() && checkQuery.next()) {
@@ -435,10 +507,9 @@ bool DatabaseManager::addFlight(const Flight& flight) {
         return false;
     }
     
-    QSqlQuery query(db);
-    query.prepare("INSERT INTO flight (flight_number, airline, departure_city, arrival_city, "
-                  "departure_time, arrival_time, total_seats, available_seats, status, price, stopover) "
-                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    PreparedQuery query = pool.prepare("INSERT INTO flight (flight_number, airline, departure_city, arrival_city, "
+                                       "departure_time, arrival_time, total_seats, available_seats, status, price, stopover) "
+                                       "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
     
     query.addBindValue(flight.flightNumber);
     query.addBindValue(flight.airline);
@@ -453,6 +524,7 @@ bool DatabaseManager::addFlight(const Flight& flight) {
     query.addBindValue(flight.stopovers.join(","));
     
     if (query.exec()) {
+        flightCache.insert(flight);
         qDebug() << "航班添加成功:" << flight.flightNumber;
         return true;
     } else {
@@ -462,7 +534,7 @@ bool DatabaseManager::addFlight(const Flight& flight) {
 }
 
 bool DatabaseManager::updateFlight(const Flight& flight) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     // 验证航班信息
     if (!flight.isValid()) {
@@ -470,10 +542,9 @@ bool DatabaseManager::updateFlight(const Flight& flight) {
         return false;
     }
     
-    QSqlQuery query(db);
-    query.prepare("UPDATE flight SET airline = ?, departure_city = ?, arrival_city = ?, "
-                  "departure_time = ?, arrival_time = ?, total_seats = ?, available_seats = ?, "
-                  "status = ?, price = ?, stopover = ? WHERE flight_number = ?");
+    PreparedQuery query = pool.prepare("UPDATE flight SET airline = ?, departure_city = ?, arrival_city = ?, "
+                                       "departure_time = ?, arrival_time = ?, total_seats = ?, available_seats = ?, "
+                                       "status = ?, price = ?, stopover = ? WHERE flight_number = ?");
     
     query.addBindValue(flight.airline);
     query.addBindValue(flight.departureCity);
@@ -488,6 +559,7 @@ bool DatabaseManager::updateFlight(const Flight& flight) {
     query.addBindValue(flight.flightNumber);
     
     if (query.exec()) {
+        flightCache.update(flight);
         qDebug() << "航班更新成功:" << flight.flightNumber;
         return true;
     } else {
@@ -497,7 +569,7 @@ bool DatabaseManager::updateFlight(const Flight& flight) {
 }
 
 bool DatabaseManager::deleteFlight(const QString& flightNumber) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     if (flightNumber.isEmpty()) {
         qDebug() << "航班号为空";
@@ -505,8 +577,7 @@ bool DatabaseManager::deleteFlight(const QString& flightNumber) {
     }
     
     // 检查是否有已预订的机票
-    QSqlQuery checkQuery(db);
-    checkQuery.prepare("SELECT COUNT(*) FROM ticket WHERE flight_number = ? AND status = ?");
+    PreparedQuery checkQuery = pool.prepare("SELECT COUNT(*) FROM ticket WHERE flight_number = ? AND status = ?");
     checkQuery.addBindValue(flightNumber);
     checkQuery.addBindValue(Constants::TICKET_BOOKED);
     
@@ -518,24 +589,22 @@ bool DatabaseManager::deleteFlight(const QString& flightNumber) {
     }
     
     // 先删除相关的预约记录
-    QSqlQuery deleteReservations(db);
-    deleteReservations.prepare("DELETE FROM reservation_queue WHERE flight_number = ?");
+    PreparedQuery deleteReservations = pool.prepare("DELETE FROM reservation_queue WHERE flight_number = ?");
     deleteReservations.addBindValue(flightNumber);
     deleteReservations.exec();
     
     // 删除相关的已取消机票
-    QSqlQuery deleteTickets(db);
-    deleteTickets.prepare("DELETE FROM ticket WHERE flight_number = ? AND status = ?");
+    PreparedQuery deleteTickets = pool.prepare("DELETE FROM ticket WHERE flight_number = ? AND status = ?");
     deleteTickets.addBindValue(flightNumber);
     deleteTickets.addBindValue(Constants::TICKET_CANCELLED);
     deleteTickets.exec();
     
     // 删除航班
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM flight WHERE flight_number = ?");
+    PreparedQuery query = pool.prepare("DELETE FROM flight WHERE flight_number = ?");
     query.addBindValue(flightNumber);
     
     if (query.exec()) {
+        flightCache.remove(flightNumber);
         qDebug() << "航班删除成功:" << flightNumber;
         return true;
     } else {
@@ -545,19 +614,19 @@ bool DatabaseManager::deleteFlight(const QString& flightNumber) {
 }
 
 bool DatabaseManager::updateFlightStatus(const QString& flightNumber, const QString& status) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     if (flightNumber.isEmpty() || status.isEmpty()) {
         qDebug() << "航班号或状态为空";
         return false;
     }
     
-    QSqlQuery query(db);
-    query.prepare("UPDATE flight SET status = ? WHERE flight_number = ?");
+    PreparedQuery query = pool.prepare("UPDATE flight SET status = ? WHERE flight_number = ?");
     query.addBindValue(status);
     query.addBindValue(flightNumber);
     
     if (query.exec()) {
+        flightCache.setStatus(flightNumber, status);
         qDebug() << "航班状态更新成功:" << flightNumber << "状态:" << status;
         return true;
     } else {
@@ -568,7 +637,7 @@ bool DatabaseManager::updateFlightStatus(const QString& flightNumber, const QStr
 
 bool DatabaseManager::updateFlightTime(const QString& flightNumber, 
                                      const QDateTime& newDep, const QDateTime& newArr) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     if (flightNumber.isEmpty() || !newDep.isValid() || !newArr.isValid()) {
         qDebug() << "参数无效";
@@ -580,13 +649,13 @@ bool DatabaseManager::updateFlightTime(const QString& flightNumber,
         return false;
     }
     
-    QSqlQuery query(db);
-    query.prepare("UPDATE flight SET departure_time = ?, arrival_time = ? WHERE flight_number = ?");
+    PreparedQuery query = pool.prepare("UPDATE flight SET departure_time = ?, arrival_time = ? WHERE flight_number = ?");
     query.addBindValue(newDep);
     query.addBindValue(newArr);
     query.addBindValue(flightNumber);
     
     if (query.exec()) {
+        flightCache.setTimes(flightNumber, newDep, newArr);
         qDebug() << "航班时间更新成功:" << flightNumber;
         return true;
     } else {
@@ -597,18 +666,17 @@ bool DatabaseManager::updateFlightTime(const QString& flightNumber,
 
 // 票务相关操作实现
 TicketResult DatabaseManager::bookTicket(int userId, const QString& flightNumber) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     // 开始事务
+    QSqlDatabase db = pool.connection();
     if (!db.transaction()) {
         qDebug() << "开始事务失败:" << db.lastError().text();
         return TicketResult::Failed;
     }
     
-    QSqlQuery query(db);
-    
     // 1. 检查航班是否存在和可用
-    query.prepare("SELECT available_seats, status, price FROM flight WHERE flight_number = ?");
+    PreparedQuery query = pool.prepare("SELECT available_seats, status, price FROM flight WHERE flight_number = ?");
     query.addBindValue(flightNumber);
     
     if (!query.exec()) {
@@ -639,7 +707,7 @@ TicketResult DatabaseManager::bookTicket(int userId, const QString& flightNumber
     }
     
     // 2. 检查用户是否存在
-    query.prepare("SELECT user_id FROM user WHERE user_id = ?");
+    query = pool.prepare("SELECT user_id FROM user WHERE user_id = ?");
     query.addBindValue(userId);
     if (!query.exec()) {
         db.rollback();
@@ -654,7 +722,7 @@ TicketResult DatabaseManager::bookTicket(int userId, const QString& flightNumber
     qDebug() << "用户验证通过:" << userId;
     
     // 3. 减少可用座位
-    query.prepare("UPDATE flight SET available_seats = available_seats - 1 WHERE flight_number = ?");
+    query = pool.prepare("UPDATE flight SET available_seats = available_seats - 1 WHERE flight_number = ?");
     query.addBindValue(flightNumber);
     if (!query.exec()) {
         db.rollback();
@@ -666,8 +734,8 @@ TicketResult DatabaseManager::bookTicket(int userId, const QString& flightNumber
     QString seatNumber = generateSeatNumber(flightNumber);
     
     // 5. 创建票务记录
-    query.prepare("INSERT INTO ticket (flight_number, user_id, status, price, seat_number, booking_time) "
-                  "VALUES (?, ?, ?, ?, ?, datetime('now'))");
+    query = pool.prepare("INSERT INTO ticket (flight_number, user_id, status, price, seat_number, booking_time) "
+                         "VALUES (?, ?, ?, ?, ?, datetime('now'))");
     query.addBindValue(flightNumber);
     query.addBindValue(userId);
     query.addBindValue(Constants::TICKET_BOOKED);
@@ -685,6 +753,7 @@ TicketResult DatabaseManager::bookTicket(int userId, const QString& flightNumber
         qDebug() << "提交事务失败:" << db.lastError().text();
         return TicketResult::Failed;
     }
+    flightCache.adjustSeats(flightNumber, -1);
     
     qDebug() << QString("购票成功: 用户%1, 航班%2, 座位%3")
                 .arg(userId).arg(flightNumber, seatNumber);
@@ -696,18 +765,17 @@ TicketResult DatabaseManager::bookTicket(int userId, const QString& flightNumber
 }
 
 bool DatabaseManager::refundTicket(int ticketId) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     // 开始事务
+    QSqlDatabase db = pool.connection();
     if (!db.transaction()) {
         qDebug() << "开始退票事务失败:" << db.lastError().text();
         return false;
     }
     
-    QSqlQuery query(db);
-    
     // 1. 获取票务信息
-    query.prepare("SELECT flight_number, status FROM ticket WHERE ticket_id = ?");
+    PreparedQuery query = pool.prepare("SELECT flight_number, status FROM ticket WHERE ticket_id = ?");
     query.addBindValue(ticketId);
     
     if (!query.exec() || !query.next()) {
@@ -727,7 +795,7 @@ bool DatabaseManager::refundTicket(int ticketId) {
     }
     
     // 2. 更新票务状态为取消
-    query.prepare("UPDATE ticket SET status = ? WHERE ticket_id = ?");
+    query = pool.prepare("UPDATE ticket SET status = ? WHERE ticket_id = ?");
     query.addBindValue(Constants::TICKET_CANCELLED);
     query.addBindValue(ticketId);
     
@@ -738,7 +806,7 @@ bool DatabaseManager::refundTicket(int ticketId) {
     }
     
     // 3. 增加航班可用座位
-    query.prepare("UPDATE flight SET available_seats = available_seats + 1 WHERE flight_number = ?");
+    query = pool.prepare("UPDATE flight SET available_seats = available_seats + 1 WHERE flight_number = ?");
     query.addBindValue(flightNumber);
     
     if (!query.exec()) {
@@ -752,6 +820,7 @@ bool DatabaseManager::refundTicket(int ticketId) {
         qDebug() << "提交退票事务失败:" << db.lastError().text();
         return false;
     }
+    flightCache.adjustSeats(flightNumber, 1);
     
     qDebug() << QString("退票成功: 票号%1, 航班%2").arg(ticketId).arg(flightNumber);
     
@@ -762,16 +831,14 @@ bool DatabaseManager::refundTicket(int ticketId) {
 }
 
 QVector<Ticket> DatabaseManager::getUserTickets(int userId) {
-    QMutexLocker locker(&dbMutex);
     QVector<Ticket> tickets;
     
-    QSqlQuery query(db);
-    query.prepare("SELECT t.ticket_id, t.flight_number, t.status, t.price, t.seat_number, "
-                  "t.booking_time, f.departure_city, f.arrival_city, f.departure_time "
-                  "FROM ticket t "
-                  "JOIN flight f ON t.flight_number = f.flight_number "
-                  "WHERE t.user_id = ? "
-                  "ORDER BY t.booking_time DESC");
+    PreparedQuery query = pool.prepare("SELECT t.ticket_id, t.flight_number, t.status, t.price, t.seat_number, "
+                                       "t.booking_time, f.departure_city, f.arrival_city, f.departure_time "
+                                       "FROM ticket t "
+                                       "JOIN flight f ON t.flight_number = f.flight_number "
+                                       "WHERE t.user_id = ? "
+                                       "ORDER BY t.booking_time DESC");
     query.addBindValue(userId);
     
     if (query.exec()) {
@@ -796,7 +863,6 @@ QVector<Ticket> DatabaseManager::getUserTickets(int userId) {
 }
 
 QVector<Ticket> DatabaseManager::getFlightTickets(const QString& flightNumber) {
-    QMutexLocker locker(&dbMutex);
     QVector<Ticket> tickets;
     
     if (flightNumber.isEmpty()) {
@@ -804,9 +870,8 @@ QVector<Ticket> DatabaseManager::getFlightTickets(const QString& flightNumber) {
         return tickets;
     }
     
-    QSqlQuery query(db);
-    query.prepare("SELECT ticket_id, flight_number, user_id, status, price, seat_number, booking_time "
-                  "FROM ticket WHERE flight_number = ? ORDER BY booking_time DESC");
+    PreparedQuery query = pool.prepare("SELECT ticket_id, flight_number, user_id, status, price, seat_number, booking_time "
+                                       "FROM ticket WHERE flight_number = ? ORDER BY booking_time DESC");
     query.addBindValue(flightNumber);
     
     if (query.exec()) {
@@ -831,7 +896,6 @@ QVector<Ticket> DatabaseManager::getFlightTickets(const QString& flightNumber) {
 }
 
 Ticket DatabaseManager::getTicket(int ticketId) {
-    QMutexLocker locker(&dbMutex);
     Ticket ticket;
     
     if (ticketId <= 0) {
@@ -839,9 +903,8 @@ Ticket DatabaseManager::getTicket(int ticketId) {
         return ticket;
     }
     
-    QSqlQuery query(db);
-    query.prepare("SELECT ticket_id, flight_number, user_id, status, price, seat_number, booking_time "
-                  "FROM ticket WHERE ticket_id = ?");
+    PreparedQuery query = pool.prepare("SELECT ticket_id, flight_number, user_id, status, price, seat_number, booking_time "
+                                       "FROM ticket WHERE ticket_id = ?");
     query.addBindValue(ticketId);
     
     if (query.exec() && query.next()) {
@@ -861,11 +924,10 @@ Ticket DatabaseManager::getTicket(int ticketId) {
 
 // 预约队列操作实现
 bool DatabaseManager::addToReservationQueue(int userId, const QString& flightNumber, int priority) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     // 检查是否已经在预约队列中
-    QSqlQuery query(db);
-    query.prepare("SELECT reservation_id FROM reservation_queue WHERE user_id = ? AND flight_number = ?");
+    PreparedQuery query = pool.prepare("SELECT reservation_id FROM reservation_queue WHERE user_id = ? AND flight_number = ?");
     query.addBindValue(userId);
     query.addBindValue(flightNumber);
     
@@ -875,7 +937,7 @@ bool DatabaseManager::addToReservationQueue(int userId, const QString& flightNum
     }
     
     // 添加到预约队列
-    query.prepare("INSERT INTO reservation_queue (flight_number, user_id, priority) VALUES (?, ?, ?)");
+    query = pool.prepare("INSERT INTO reservation_queue (flight_number, user_id, priority) VALUES (?, ?, ?)");
     query.addBindValue(flightNumber);
     query.addBindValue(userId);
     query.addBindValue(priority);
@@ -891,10 +953,9 @@ bool DatabaseManager::addToReservationQueue(int userId, const QString& flightNum
 }
 
 bool DatabaseManager::removeFromReservationQueue(int reservationId) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
-    QSqlQuery query(db);
-    query.prepare("DELETE FROM reservation_queue WHERE reservation_id = ?");
+    PreparedQuery query = pool.prepare("DELETE FROM reservation_queue WHERE reservation_id = ?");
     query.addBindValue(reservationId);
     
     if (query.exec()) {
@@ -907,7 +968,6 @@ bool DatabaseManager::removeFromReservationQueue(int reservationId) {
 }
 
 QVector<Reservation> DatabaseManager::getFlightReservations(const QString& flightNumber) {
-    QMutexLocker locker(&dbMutex);
     QVector<Reservation> reservations;
     
     if (flightNumber.isEmpty()) {
@@ -915,13 +975,12 @@ QVector<Reservation> DatabaseManager::getFlightReservations(const QString& fligh
         return reservations;
     }
     
-    QSqlQuery query(db);
-    query.prepare("SELECT r.reservation_id, r.flight_number, r.user_id, r.priority, r.request_time, "
-                  "u.username "
-                  "FROM reservation_queue r "
-                  "LEFT JOIN user u ON r.user_id = u.user_id "
-                  "WHERE r.flight_number = ? "
-                  "ORDER BY r.priority DESC, r.request_time ASC");
+    PreparedQuery query = pool.prepare("SELECT r.reservation_id, r.flight_number, r.user_id, r.priority, r.request_time, "
+                                       "u.username "
+                                       "FROM reservation_queue r "
+                                       "LEFT JOIN user u ON r.user_id = u.user_id "
+                                       "WHERE r.flight_number = ? "
+                                       "ORDER BY r.priority DESC, r.request_time ASC");
     query.addBindValue(flightNumber);
     
     if (query.exec()) {
@@ -944,16 +1003,14 @@ QVector<Reservation> DatabaseManager::getFlightReservations(const QString& fligh
 }
 
 QVector<Reservation> DatabaseManager::getUserReservations(int userId) {
-    QMutexLocker locker(&dbMutex);
     QVector<Reservation> reservations;
     
-    QSqlQuery query(db);
-    query.prepare("SELECT r.reservation_id, r.flight_number, r.priority, r.request_time, "
-                  "f.departure_city, f.arrival_city, f.departure_time "
-                  "FROM reservation_queue r "
-                  "JOIN flight f ON r.flight_number = f.flight_number "
-                  "WHERE r.user_id = ? "
-                  "ORDER BY r.request_time DESC");
+    PreparedQuery query = pool.prepare("SELECT r.reservation_id, r.flight_number, r.priority, r.request_time, "
+                                       "f.departure_city, f.arrival_city, f.departure_time "
+                                       "FROM reservation_queue r "
+                                       "JOIN flight f ON r.flight_number = f.flight_number "
+                                       "WHERE r.user_id = ? "
+                                       "ORDER BY r.request_time DESC");
     query.addBindValue(userId);
     
     if (query.exec()) {
@@ -976,11 +1033,10 @@ QVector<Reservation> DatabaseManager::getUserReservations(int userId) {
 }
 
 void DatabaseManager::processReservationQueue(const QString& flightNumber) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
     // 检查是否有可用座位
-    QSqlQuery query(db);
-    query.prepare("SELECT available_seats FROM flight WHERE flight_number = ?");
+    PreparedQuery query = pool.prepare("SELECT available_seats FROM flight WHERE flight_number = ?");
     query.addBindValue(flightNumber);
     
     if (!query.exec() || !query.next()) {
@@ -993,10 +1049,10 @@ void DatabaseManager::processReservationQueue(const QString& flightNumber) {
     }
     
     // 获取预约队列中的用户（按优先级和时间排序）
-    query.prepare("SELECT reservation_id, user_id, priority FROM reservation_queue "
-                  "WHERE flight_number = ? "
-                  "ORDER BY priority DESC, request_time ASC "
-                  "LIMIT ?");
+    query = pool.prepare("SELECT reservation_id, user_id, priority FROM reservation_queue "
+                         "WHERE flight_number = ? "
+                         "ORDER BY priority DESC, request_time ASC "
+                         "LIMIT ?");
     query.addBindValue(flightNumber);
     query.addBindValue(availableSeats);
     
@@ -1016,8 +1072,7 @@ void DatabaseManager::processReservationQueue(const QString& flightNumber) {
             
             // 直接创建票务记录，避免递归调用bookTicket
             // 1. 减少可用座位
-            QSqlQuery updateQuery(db);
-            updateQuery.prepare("UPDATE flight SET available_seats = available_seats - 1 WHERE flight_number = ? AND available_seats > 0");
+            PreparedQuery updateQuery = pool.prepare("UPDATE flight SET available_seats = available_seats - 1 WHERE flight_number = ? AND available_seats > 0");
             updateQuery.addBindValue(flightNumber);
             
             if (!updateQuery.exec() || updateQuery.numRowsAffected() == 0) {
@@ -1025,8 +1080,7 @@ void DatabaseManager::processReservationQueue(const QString& flightNumber) {
             }
             
             // 2. 获取价格
-            QSqlQuery priceQuery(db);
-            priceQuery.prepare("SELECT price FROM flight WHERE flight_number = ?");
+            PreparedQuery priceQuery = pool.prepare("SELECT price FROM flight WHERE flight_number = ?");
             priceQuery.addBindValue(flightNumber);
             
             double price = 0.0;
@@ -1038,9 +1092,8 @@ void DatabaseManager::processReservationQueue(const QString& flightNumber) {
             QString seatNumber = generateSeatNumber(flightNumber);
             
             // 4. 创建票务记录
-            QSqlQuery ticketQuery(db);
-            ticketQuery.prepare("INSERT INTO ticket (flight_number, user_id, status, price, seat_number, booking_time) "
-                              "VALUES (?, ?, ?, ?, ?, datetime('now'))");
+            PreparedQuery ticketQuery = pool.prepare("INSERT INTO ticket (flight_number, user_id, status, price, seat_number, booking_time) "
+                                                     "VALUES (?, ?, ?, ?, ?, datetime('now'))");
             ticketQuery.addBindValue(flightNumber);
             ticketQuery.addBindValue(userId);
             ticketQuery.addBindValue(Constants::TICKET_BOOKED);
@@ -1048,13 +1101,13 @@ void DatabaseManager::processReservationQueue(const QString& flightNumber) {
             ticketQuery.addBindValue(seatNumber);
             
             if (ticketQuery.exec()) {
+                flightCache.adjustSeats(flightNumber, -1);
                 // 购票成功，从预约队列中移除
                 removeFromReservationQueue(reservationId);
                 qDebug() << QString("自动购票成功: 用户%1, 航班%2, 座位%3").arg(userId).arg(flightNumber).arg(seatNumber);
             } else {
                 // 回滚座位数量
-                QSqlQuery rollbackQuery(db);
-                rollbackQuery.prepare("UPDATE flight SET available_seats = available_seats + 1 WHERE flight_number = ?");
+                PreparedQuery rollbackQuery = pool.prepare("UPDATE flight SET available_seats = available_seats + 1 WHERE flight_number = ?");
                 rollbackQuery.addBindValue(flightNumber);
                 rollbackQuery.exec();
                 qDebug() << "自动购票失败:" << ticketQuery.lastError().text();
@@ -1066,10 +1119,8 @@ void DatabaseManager::processReservationQueue(const QString& flightNumber) {
 
 // 统计信息实现
 int DatabaseManager::getTotalFlights() {
-    QMutexLocker locker(&dbMutex);
-    
-    QSqlQuery query(db);
-    if (query.exec("SELECT COUNT(*) FROM flight")) {
+    PreparedQuery query = pool.prepare("SELECT COUNT(*) FROM flight");
+    if (query.exec()) {
         if (query.next()) {
             int count = query.value(0).toInt();
             qDebug() << "航班总数:" << count;
@@ -1083,10 +1134,8 @@ int DatabaseManager::getTotalFlights() {
 }
 
 int DatabaseManager::getAvailableFlights() {
-    QMutexLocker locker(&dbMutex);
-    
-    QSqlQuery query(db);
-    if (query.exec("SELECT COUNT(*) FROM flight WHERE status = 'Scheduled' AND available_seats > 0")) {
+    PreparedQuery query = pool.prepare("SELECT COUNT(*) FROM flight WHERE status = 'Scheduled' AND available_seats > 0");
+    if (query.exec()) {
         if (query.next()) {
             int count = query.value(0).toInt();
             qDebug() << "可用航班数:" << count;
@@ -1100,10 +1149,8 @@ int DatabaseManager::getAvailableFlights() {
 }
 
 int DatabaseManager::getTotalUsers() {
-    QMutexLocker locker(&dbMutex);
-    
-    QSqlQuery query(db);
-    if (query.exec("SELECT COUNT(*) FROM user")) {
+    PreparedQuery query = pool.prepare("SELECT COUNT(*) FROM user");
+    if (query.exec()) {
         if (query.next()) {
             int count = query.value(0).toInt();
             qDebug() << "用户总数:" << count;
@@ -1117,47 +1164,20 @@ int DatabaseManager::getTotalUsers() {
 }
 
 QVector<QString> DatabaseManager::getAllCities() {
-    QMutexLocker locker(&dbMutex);
-    QVector<QString> cities;
-    QSet<QString> citySet; // 使用Set去重
-    
-    QSqlQuery query(db);
-    if (query.exec("SELECT DISTINCT departure_city FROM flight WHERE departure_city IS NOT NULL AND departure_city != ''")) {
-        while (query.next()) {
-            QString city = query.value(0).toString();
-            if (!city.isEmpty() && !citySet.contains(city)) {
-                citySet.insert(city);
-                cities.append(city);
-            }
-        }
-    }
-    
-    // 添加目的地城市
-    if (query.exec("SELECT DISTINCT arrival_city FROM flight WHERE arrival_city IS NOT NULL AND arrival_city != ''")) {
-        while (query.next()) {
-            QString city = query.value(0).toString();
-            if (!city.isEmpty() && !citySet.contains(city)) {
-                citySet.insert(city);
-                cities.append(city);
-            }
-        }
-    }
-    
-    if (cities.isEmpty()) {
-        qDebug() << "获取城市列表失败:" << query.lastError().text();
+    if (!ensureFlightCache()) {
+        qDebug() << "获取城市列表失败";
+        return QVector<QString>();
     }
     
+    QVector<QString> cities = flightCache.cities();
     qDebug() << "获取城市数量:" << cities.size();
     return cities;
 }
 
 // 工具方法实现
 QString DatabaseManager::generateSeatNumber(const QString& flightNumber) {
-    QMutexLocker locker(&dbMutex);
-    
     // 获取已使用的座位号
-    QSqlQuery query(db);
-    query.prepare("SELECT seat_number FROM ticket WHERE flight_number = ? AND status != ?");
+    PreparedQuery query = pool.prepare("SELECT seat_number FROM ticket WHERE flight_number = ? AND status != ?");
     query.addBindValue(flightNumber);
     query.addBindValue(Constants::TICKET_CANCELLED);
     
@@ -1190,12 +1210,10 @@ QString DatabaseManager::generateSeatNumber(const QString& flightNumber) {
 }
 
 QVector<int> DatabaseManager::getAffectedUsers(const QString& flightNumber) {
-    QMutexLocker locker(&dbMutex);
     QVector<int> userIds;
     
-    QSqlQuery query(db);
     // 获取购买该航班机票的用户
-    query.prepare("SELECT DISTINCT user_id FROM ticket WHERE flight_number = ? AND status != ?");
+    PreparedQuery query = pool.prepare("SELECT DISTINCT user_id FROM ticket WHERE flight_number = ? AND status != ?");
     query.addBindValue(flightNumber);
     query.addBindValue(Constants::TICKET_CANCELLED);
     
@@ -1206,7 +1224,7 @@ QVector<int> DatabaseManager::getAffectedUsers(const QString& flightNumber) {
     }
     
     // 获取预约该航班的用户
-    query.prepare("SELECT DISTINCT user_id FROM reservation_queue WHERE flight_number = ?");
+    query = pool.prepare("SELECT DISTINCT user_id FROM reservation_queue WHERE flight_number = ?");
     query.addBindValue(flightNumber);
     
     if (query.exec()) {
@@ -1223,11 +1241,9 @@ QVector<int> DatabaseManager::getAffectedUsers(const QString& flightNumber) {
 
 // 管理员功能实现
 QVector<User> DatabaseManager::getAllUsers() {
-    QMutexLocker locker(&dbMutex);
     QVector<User> users;
     
-    QSqlQuery query(db);
-    query.prepare("SELECT user_id, username, email, phone, user_type FROM user ORDER BY user_id");
+    PreparedQuery query = pool.prepare("SELECT user_id, username, email, phone, user_type FROM user ORDER BY user_id");
     
     if (query.exec()) {
         while (query.next()) {
@@ -1248,10 +1264,9 @@ QVector<User> DatabaseManager::getAllUsers() {
 }
 
 bool DatabaseManager::resetUserPassword(int userId, const QString& newPassword) {
-    QMutexLocker locker(&dbMutex);
+    QMutexLocker locker(&writeMutex);
     
-    QSqlQuery query(db);
-    query.prepare("UPDATE user SET password = ? WHERE user_id = ?");
+    PreparedQuery query = pool.prepare("UPDATE user SET password = ? WHERE user_id = ?");
     query.addBindValue(newPassword); // 直接使用明文密码
     query.addBindValue(userId);
     
@@ -1265,12 +1280,10 @@ bool DatabaseManager::resetUserPassword(int userId, const QString& newPassword)
 }
 
 QVector<Ticket> DatabaseManager::getAllTickets() {
-    QMutexLocker locker(&dbMutex);
     QVector<Ticket> tickets;
     
-    QSqlQuery query(db);
-    query.prepare("SELECT ticket_id, flight_number, user_id, status, price, seat_number, booking_time "
-                  "FROM ticket ORDER BY booking_time DESC");
+    PreparedQuery query = pool.prepare("SELECT ticket_id, flight_number, user_id, status, price, seat_number, booking_time "
+                                       "FROM ticket ORDER BY booking_time DESC");
     
     if (query.exec()) {
         while (query.next()) {
@@ -1293,16 +1306,13 @@ QVector<Ticket> DatabaseManager::getAllTickets() {
 }
 
 double DatabaseManager::getTotalRevenue(const QDate& fromDate, const QDate& toDate) {
-    QMutexLocker locker(&dbMutex);
-    
-    QSqlQuery query(db);
     QString sql = "SELECT SUM(price) FROM ticket WHERE status = ?";
     
     if (fromDate.isValid() && toDate.isValid()) {
         sql += " AND DATE(booking_time) BETWEEN ? AND ?";
     }
     
-    query.prepare(sql);
+    PreparedQuery query = pool.prepare(sql);
     query.addBindValue(Constants::TICKET_BOOKED);
     
     if (fromDate.isValid() && toDate.isValid()) {
@@ -1318,16 +1328,13 @@ double DatabaseManager::getTotalRevenue(const QDate& fromDate, const QDate& toDa
 }
 
 int DatabaseManager::getFlightCount(const QDate& fromDate, const QDate& toDate) {
-    QMutexLocker locker(&dbMutex);
-    
-    QSqlQuery query(db);
     QString sql = "SELECT COUNT(*) FROM flight";
     
     if (fromDate.isValid() && toDate.isValid()) {
         sql += " WHERE DATE(departure_time) BETWEEN ? AND ?";
     }
     
-    query.prepare(sql);
+    PreparedQuery query = pool.prepare(sql);
     
     if (fromDate.isValid() && toDate.isValid()) {
         query.addBindValue(fromDate.toString("yyyy-MM-dd"));
@@ -1349,16 +1356,13 @@ int DatabaseManager::getUserCount(const QDate& fromDate, const QDate& toDate) {
 }
 
 int DatabaseManager::getTicketCount(const QDate& fromDate, const QDate& toDate) {
-    QMutexLocker locker(&dbMutex);
-    
-    QSqlQuery query(db);
     QString sql = "SELECT COUNT(*) FROM ticket WHERE status = ?";
     
     if (fromDate.isValid() && toDate.isValid()) {
         sql += " AND DATE(booking_time) BETWEEN ? AND ?";
     }
     
-    query.prepare(sql);
+    PreparedQuery query = pool.prepare(sql);
     query.addBindValue(Constants::TICKET_BOOKED);
     
     if (fromDate.isValid() && toDate.isValid()) {
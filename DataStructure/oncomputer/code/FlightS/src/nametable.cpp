@@ -0,0 +1,33 @@
+#include "../include/nametable.h"
+#include <algorithm>
+
+int NameTable::intern(const QString& name) {
+    auto it = ids.constFind(name);
+    if (it != ids.constEnd()) {
+        return it.value();
+    }
+    int id = names.size();
+    ids.insert(name, id);
+    names.append(name);
+    return id;
+}
+
+int NameTable::id(const QString& name) const {
+    return ids.value(name, -1);
+}
+
+void NameTable::clear() {
+    ids.clear();
+    names.clear();
+}
+
+void NameTable::assignSorted(QVector<QString> values) {
+    clear();
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    ids.reserve(values.size());
+    for (int i = 0; i < values.size(); ++i) {
+        ids.insert(values[i], i);
+    }
+    names = values;
+}
@@ -0,0 +1,101 @@
+// 转机推荐的回归测试：经停航班整段乘坐时，最快、最便宜和推荐方案都应返回原航班
+// （真实的航班号、起降时间和票价），而不是拆分出来的航段
+//
+// 用法: route_test
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include "../../include/flightgraph.h"
+
+static int failures = 0;
+
+static void check(QTextStream& out, bool condition, const QString& what)
+{
+    if (!condition) {
+        out << "失败: " << what << Qt::endl;
+        failures++;
+    }
+}
+
+static Flight makeFlight(const QString& number, const QString& from, const QString& to,
+                         const QDateTime& departure, const QDateTime& arrival, double price)
+{
+    Flight flight;
+    flight.flightNumber = number;
+    flight.airline = "测试航空";
+    flight.departureCity = from;
+    flight.arrivalCity = to;
+    flight.departureTime = departure;
+    flight.arrivalTime = arrival;
+    flight.totalSeats = 100;
+    flight.availableSeats = 100;
+    flight.status = Constants::FLIGHT_SCHEDULED;
+    flight.price = price;
+    return flight;
+}
+
+// 只有一个方案、方案只有一个航班，并且就是original
+static void checkWholeFlight(QTextStream& out, const QVector<TransferPlan>& plans,
+                             const Flight& original, const QString& query)
+{
+    check(out, plans.size() == 1, query + ": 应只有一个方案");
+    if (plans.isEmpty()) {
+        return;
+    }
+    const TransferPlan& plan = plans.first();
+    check(out, plan.flights.size() == 1, query + ": 方案应只有一个航班");
+    if (plan.flights.isEmpty()) {
+        return;
+    }
+    const Flight& flight = plan.flights.first();
+    check(out, flight.flightNumber == original.flightNumber, query + ": 航班号应为 " + original.flightNumber);
+    check(out, flight.price == original.price, query + ": 票价应与原航班相同");
+    check(out, plan.totalPrice == original.price, query + ": 总价应与原航班票价相同");
+    check(out, flight.departureTime == original.departureTime && flight.arrivalTime == original.arrivalTime,
+           query + ": 起降时间应与原航班相同");
+    check(out, flight.stopovers == original.stopovers, query + ": 经停地应与原航班相同");
+    check(out, plan.transferCount == 0, query + ": 经停不算换乘");
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QDate date(2025, 7, 1);
+    // 一次经停的航班，票价平分到两段时有舍入误差
+    Flight oneStop = makeFlight("CA1234", "北京", "广州",
+                                QDateTime(date, QTime(8, 0)), QDateTime(date, QTime(12, 0)), 999.99);
+    oneStop.stopovers << "武汉";
+    // 全程很短却有多个经停地，拆出的航段也必须在起降时间之内并且先后有序
+    Flight shortHops = makeFlight("MU5678", "上海", "杭州",
+                                  QDateTime(date, QTime(9, 0)), QDateTime(date, QTime(9, 40)), 300.0);
+    shortHops.stopovers << "苏州" << "无锡" << "嘉兴";
+
+    FlightGraph graph;
+    graph.buildGraph(QVector<Flight>() << oneStop << shortHops);
+
+    checkWholeFlight(out, graph.findFastestRoutes("北京", "广州", date), oneStop, "最快方案");
+    checkWholeFlight(out, graph.findCheapestRoutes("北京", "广州", date), oneStop, "最便宜方案");
+    checkWholeFlight(out, graph.recommendTransfers("北京", "广州", date), oneStop, "推荐方案");
+    checkWholeFlight(out, graph.recommendTransfers("上海", "杭州", date), shortHops, "多经停短航班");
+
+    // 只乘到经停地时返回拆出的航段，时间在原航班之内
+    TransferPlan partial = graph.findEarliestArrival("北京", "武汉", QDateTime(date, QTime(0, 0)));
+    check(out, partial.flights.size() == 1, "乘到经停地: 应只有一个航段");
+    if (!partial.flights.isEmpty()) {
+        const Flight& leg = partial.flights.first();
+        check(out, leg.departureTime == oneStop.departureTime, "乘到经停地: 起飞时间应为原航班起飞时间");
+        check(out, leg.arrivalTime > leg.departureTime && leg.arrivalTime < oneStop.arrivalTime,
+               "乘到经停地: 到达时间应在原航班起降时间之间");
+    }
+    for (const QString& stopover : shortHops.stopovers) {
+        TransferPlan hop = graph.findEarliestArrival("上海", stopover, QDateTime(date, QTime(0, 0)));
+        check(out, !hop.flights.isEmpty() && hop.arrivalTime >= hop.departureTime
+                   && hop.departureTime >= shortHops.departureTime && hop.arrivalTime <= shortHops.arrivalTime,
+               "多经停短航班: 到 " + stopover + " 的航段应在原航班起降时间之内");
+    }
+
+    out << QString("转机推荐回归测试: 错误 %1").arg(failures) << Qt::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+# 转机推荐的回归测试（控制台程序），发现错误时返回非0
+QT = core sql
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = route_test
+
+INCLUDEPATH += ../../include
+
+SOURCES += \
+    main.cpp \
+    ../../src/connectionscan.cpp \
+    ../../src/flightgraph.cpp \
+    ../../src/nametable.cpp
+
+HEADERS += \
+    ../../include/connectionscan.h \
+    ../../include/flightgraph.h \
+    ../../include/nametable.h
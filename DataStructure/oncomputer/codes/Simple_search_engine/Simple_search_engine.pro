@@ -0,0 +1,19 @@
+# 顶层工程：先编译不依赖界面的核心静态库，再编译链接它的各个程序
+# 在 Qt Creator 中打开这个工程即可编译全部程序；单独打开某个程序的工程时核心代码直接编进该程序
+#   searchcore  分词、建索引、段文件和查询
+#   app         界面程序
+#   benchmark   建索引基准测试和跳表压力测试（index_benchmark）
+#   loadtest    导入文件夹并多线程重放查询日志（search_loadtest）
+
+TEMPLATE = subdirs
+
+SUBDIRS = searchcore app benchmark loadtest
+
+searchcore.file = Simple_search_engine/searchcore/searchcore.pro
+app.file = Simple_search_engine/Simple_search_engine.pro
+benchmark.file = Simple_search_engine/benchmark/benchmark.pro
+loadtest.file = Simple_search_engine/loadtest/loadtest.pro
+
+app.depends = searchcore
+benchmark.depends = searchcore
+loadtest.depends = searchcore
@@ -0,0 +1,11 @@
+QT = core core5compat concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = index_benchmark
+
+include(../searchcore.pri)
+
+SOURCES += \
+    main.cpp
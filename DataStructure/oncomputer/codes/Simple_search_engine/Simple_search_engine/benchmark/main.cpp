@@ -0,0 +1,329 @@
+// 无界面的索引构建基准测试：读取文件夹中的全部txt文件，重复建立索引并统计吞吐量，
+// 最后写出索引段并重新映射，测量冷启动时间。
+// 指定线程数可以比较分词建表和冻结词典两个阶段随核数的伸缩。
+// --stress 对双数组字典树和并发跳表做正确性和读写压力测试，发现错误时返回非0
+//
+// 用法: index_benchmark <文件夹> [重复次数] [线程数]
+//       index_benchmark --stress [写线程数] [读线程数]
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include "documentreader.h"
+#include "indexbuilder.h"
+#include "indexreader.h"
+#include "segment.h"
+#include "termtrie.h"
+
+static QVector<QString> loadDocuments(const QString& folderPath)
+{
+    QDir directory(folderPath);
+    QStringList fileNames = directory.entryList(QStringList() << "*.txt", QDir::Files);
+
+    QVector<QString> contents;
+    contents.reserve(fileNames.size());
+    for (const QString& fileName : fileNames) {
+        QString content;
+        if (DocumentReader::read(directory.filePath(fileName), content)) {
+            contents.append(content);
+        }
+    }
+    return contents;
+}
+
+// 字典树回归测试：用很小的字符集随机生成大量小词表，前缀重叠多、空闲单元容易用完，
+// 检查每个词都能查到自己的序号
+static int stressTermTrie(QTextStream& out)
+{
+    const int ROUNDS = 20000;
+
+    QVector<QVector<QString>> cases;
+    cases.append(QVector<QString>() << "a" << "ac" << "b" << "ba");
+    std::mt19937 random(2024);
+    for (int round = 0; round < ROUNDS; ++round) {
+        int letters = 1 + random() % 4;
+        int count = 1 + random() % 12;
+        QVector<QString> terms;
+        for (int i = 0; i < count; ++i) {
+            QString term;
+            int length = 1 + random() % 4;
+            for (int k = 0; k < length; ++k) {
+                term.append(QChar('a' + int(random() % letters)));
+            }
+            terms.append(term);
+        }
+        std::sort(terms.begin(), terms.end());
+        terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+        cases.append(terms);
+    }
+
+    int errors = 0;
+    for (const QVector<QString>& terms : cases) {
+        TermTrie trie;
+        trie.build(terms);
+        TermTrieView view = trie.view();
+        for (int i = 0; i < terms.size(); ++i) {
+            if (view.find(terms[i]) != i) {
+                if (errors == 0) {
+                    out << "字典树查找错误:";
+                    for (const QString& term : terms) {
+                        out << ' ' << term;
+                    }
+                    out << " 中的 " << terms[i] << Qt::endl;
+                }
+                errors++;
+            }
+        }
+    }
+
+    out << QString("字典树回归测试: %1 个词表, 错误 %2").arg(cases.size()).arg(errors) << Qt::endl;
+    return errors == 0 ? 0 : 1;
+}
+
+// 跳表压力测试：写线程以随机顺序插入各自的关键词，其中第一个写线程还不断向同一个关键词拼接文档；
+// 读线程同时反复检查：
+//   快照内关键词严格递增，同一快照遍历两次结果相同，后一个快照不比前一个小，
+//   已完成的插入一定能找到，拼接的倒排表docId连续递增
+static int stressSkipList(QTextStream& out, int writers, int readers)
+{
+    const int KEYS_PER_WRITER = 20000;
+    const QString SHARED_KEY = "shared";
+
+    QVector<QStringList> keys(writers);
+    for (int w = 0; w < writers; ++w) {
+        for (int i = 0; i < KEYS_PER_WRITER; ++i) {
+            keys[w].append(QString("w%1_%2").arg(w).arg(i, 6, 10, QChar('0')));
+        }
+        std::shuffle(keys[w].begin(), keys[w].end(), std::mt19937(w));
+    }
+
+    SkipList list;
+    QVector<std::atomic<int>*> progress;
+    for (int w = 0; w < writers; ++w) {
+        progress.append(new std::atomic<int>(0));
+    }
+    std::atomic<int> runningWriters(writers);
+    std::atomic<int> errors(0);
+    std::atomic<qint64> checks(0);
+
+    auto writer = [&](int w) {
+        for (int i = 0; i < KEYS_PER_WRITER; ++i) {
+            InvertedIndexNode node(keys[w][i]);
+            node.postings.add(i, QVector<int>() << 0);
+            node.postings.finish();
+            list.insert(node);
+            progress[w]->store(i + 1, std::memory_order_release);
+
+            if (w == 0) {
+                InvertedIndexNode shared(SHARED_KEY);
+                shared.postings.add(i, QVector<int>() << 0);
+                shared.postings.finish();
+                list.insert(shared);
+            }
+        }
+        runningWriters--;
+    };
+
+    auto reader = [&](int r) {
+        std::mt19937 random(1000 + r);
+        int lastCount = 0;
+        int lastShared = 0;
+        while (runningWriters.load() > 0) {
+            quint64 snapshot = list.snapshot();
+            int count = 0;
+            QString previous;
+            for (auto it = list.begin(snapshot); it != list.end(); ++it) {
+                if (count > 0 && !(previous < (*it).keyword)) {
+                    errors++;
+                }
+                previous = (*it).keyword;
+                count++;
+            }
+            int again = 0;
+            for (auto it = list.begin(snapshot); it != list.end(); ++it) {
+                again++;
+            }
+            if (again != count || count < lastCount) {
+                errors++;
+            }
+            lastCount = count;
+
+            for (int k = 0; k < 100; ++k) {
+                int w = random() % writers;
+                int done = progress[w]->load(std::memory_order_acquire);
+                if (done > 0 && !list.find(keys[w][random() % done])) {
+                    errors++;
+                }
+            }
+
+            if (const InvertedIndexNode* shared = list.find(SHARED_KEY)) {
+                PostingIterator it = shared->postings.iterator();
+                int expected = 0;
+                while (it.next()) {
+                    if (it.docId() != expected++) {
+                        errors++;
+                        break;
+                    }
+                }
+                if (expected < lastShared) {
+                    errors++;
+                }
+                lastShared = expected;
+            }
+            checks++;
+        }
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(writers + readers);
+    QElapsedTimer timer;
+    timer.start();
+    QVector<QFuture<void>> futures;
+    for (int r = 0; r < readers; ++r) {
+        futures.append(QtConcurrent::run(&pool, [&reader, r]() { reader(r); }));
+    }
+    for (int w = 0; w < writers; ++w) {
+        futures.append(QtConcurrent::run(&pool, [&writer, w]() { writer(w); }));
+    }
+    for (QFuture<void>& future : futures) {
+        future.waitForFinished();
+    }
+
+    // 写线程结束后检查最终结果
+    if (list.size() != writers * KEYS_PER_WRITER + 1) {
+        errors++;
+    }
+    const InvertedIndexNode* shared = list.find(SHARED_KEY);
+    if (!shared || shared->postings.documentFrequency() != KEYS_PER_WRITER) {
+        errors++;
+    }
+    qDeleteAll(progress);
+
+    out << QString("跳表压力测试: %1 个写线程, %2 个读线程, 插入 %3 个关键词, 读线程检查 %4 次, 用时 %5 ms, 错误 %6")
+               .arg(writers).arg(readers)
+               .arg(writers * KEYS_PER_WRITER)
+               .arg(checks.load())
+               .arg(timer.elapsed())
+               .arg(errors.load()) << Qt::endl;
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QStringList args = QCoreApplication::arguments();
+    if (args.size() < 2) {
+        out << "用法: index_benchmark <文件夹> [重复次数] [线程数]" << Qt::endl;
+        return 1;
+    }
+    if (args.at(1) == "--stress") {
+        int writers = args.size() > 2 ? qMax(1, args.at(2).toInt()) : 4;
+        int readers = args.size() > 3 ? qMax(1, args.at(3).toInt()) : 4;
+        int trieResult = stressTermTrie(out);
+        return stressSkipList(out, writers, readers) | trieResult;
+    }
+    QString folderPath = args.at(1);
+    int rounds = args.size() > 2 ? qMax(1, args.at(2).toInt()) : 5;
+    if (args.size() > 3) {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, args.at(3).toInt()));
+    }
+    out << QString("线程数: %1").arg(QThreadPool::globalInstance()->maxThreadCount()) << Qt::endl;
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<QString> contents = loadDocuments(folderPath);
+    qint64 loadMs = timer.elapsed();
+    if (contents.isEmpty()) {
+        out << "文件夹中没有找到文本文件: " << folderPath << Qt::endl;
+        return 1;
+    }
+
+    qint64 totalChars = 0;
+    for (const QString& content : contents) {
+        totalChars += content.length();
+    }
+    out << QString("读取 %1 个文档，共 %2 字符，用时 %3 ms")
+               .arg(contents.size()).arg(totalChars).arg(loadMs) << Qt::endl;
+
+    qint64 bestNs = -1;
+    for (int round = 1; round <= rounds; ++round) {
+        SkipList index;
+        QVector<DocumentStats> documentStats;
+        TermDictionary dictionary;
+
+        timer.start();
+        QList<BatchRange> batches = IndexBuilder::makeBatches(contents.size());
+        QList<IndexBatch> results = QtConcurrent::blockingMapped(batches, [&contents, &dictionary](const BatchRange& range) {
+            return IndexBuilder::processBatch(contents, range, dictionary);
+        });
+        qint64 buildNs = timer.nsecsElapsed();
+        IndexBuilder::mergeBatches(results, dictionary, index, documentStats);
+        qint64 elapsedNs = timer.nsecsElapsed();
+
+        qint64 postingBytes = 0;
+        for (const InvertedIndexNode& node : index) {
+            postingBytes += node.postings.memoryUsage();
+        }
+        qint64 offsetBytes = 0;
+        for (const DocumentStats& stats : documentStats) {
+            offsetBytes += stats.tokenOffsets.memoryUsage();
+        }
+
+        double seconds = elapsedNs / 1e9;
+        out << QString("第 %1 轮: %2 ms (分词建表 %3 ms, 冻结词典 %4 ms), %5 文档/秒, %6 个词条, 倒排表 %7 KB, 词位置表 %8 KB")
+                   .arg(round)
+                   .arg(elapsedNs / 1e6, 0, 'f', 1)
+                   .arg(buildNs / 1e6, 0, 'f', 1)
+                   .arg((elapsedNs - buildNs) / 1e6, 0, 'f', 1)
+                   .arg(contents.size() / seconds, 0, 'f', 0)
+                   .arg(index.size())
+                   .arg(postingBytes / 1024)
+                   .arg(offsetBytes / 1024) << Qt::endl;
+
+        if (bestNs < 0 || elapsedNs < bestNs) {
+            bestNs = elapsedNs;
+        }
+
+        // 最后一轮写出索引段并重新映射
+        if (round == rounds) {
+            QVector<QString> paths;
+            MemoryIndexReader reader(&index, &documentStats, &paths);
+            QString segmentPath = QDir::temp().filePath("index_benchmark.seg");
+            QString error;
+
+            timer.start();
+            if (!Segment::write(segmentPath, reader, &error)) {
+                out << error << Qt::endl;
+                return 1;
+            }
+            qint64 writeMs = timer.elapsed();
+
+            Segment segment;
+            timer.start();
+            if (!segment.open(segmentPath, &error)) {
+                out << error << Qt::endl;
+                return 1;
+            }
+            qint64 openNs = timer.nsecsElapsed();
+
+            out << QString("索引段: %1 KB, 写入 %2 ms, 映射并校验 %3 ms")
+                       .arg(segment.fileSize() / 1024)
+                       .arg(writeMs)
+                       .arg(openNs / 1e6, 0, 'f', 2) << Qt::endl;
+            segment.close();
+            QFile::remove(segmentPath);
+        }
+    }
+
+    out << QString("最佳: %1 文档/秒").arg(contents.size() / (bestNs / 1e9), 0, 'f', 0) << Qt::endl;
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef BM25SCORER_H
+#define BM25SCORER_H
+
+#include <QtGlobal>
+#include <QtMath>
+
+// BM25相关度打分
+//   score = idf * tf * (k1 + 1) / (tf + k1 * (1 - b + b * dl / avgdl))
+//   idf   = ln(1 + (N - df + 0.5) / (df + 0.5))
+class Bm25Scorer {
+public:
+    Bm25Scorer(double k1 = 1.2, double b = 0.75)
+        : k1(k1), b(b), documentCount(0), averageLength(1.0), minLength(0) {}
+
+    // 设置文档集合的统计信息：文档数、平均词数、最短文档词数
+    void setCollection(int count, double avgLength, int minLen)
+    {
+        documentCount = count;
+        averageLength = avgLength > 0 ? avgLength : 1.0;
+        minLength = minLen;
+    }
+
+    double idf(int documentFrequency) const
+    {
+        return qLn(1.0 + (documentCount - documentFrequency + 0.5) / (documentFrequency + 0.5));
+    }
+
+    double score(double termIdf, int tf, int documentLength) const
+    {
+        double norm = k1 * (1.0 - b + b * documentLength / averageLength);
+        return termIdf * tf * (k1 + 1.0) / (tf + norm);
+    }
+
+    // 一个词在任意文档中可能得到的最高分：分数随tf增大、随文档长度减小，
+    // 因此取该词的最大词频和集合中最短的文档长度
+    double upperBound(double termIdf, int maxTf) const
+    {
+        return score(termIdf, maxTf, minLength);
+    }
+
+private:
+    double k1;
+    double b;
+    int documentCount;
+    double averageLength;
+    int minLength;
+};
+
+#endif // BM25SCORER_H
@@ -0,0 +1,322 @@
+#include "dociterator.h"
+#include <algorithm>
+
+TermDocIterator::TermDocIterator(const PostingView& postings)
+    : it(postings.iterator()), documentFrequency(postings.documentFrequency)
+{
+}
+
+AllDocsIterator::AllDocsIterator(int documentCount)
+    : documentCount(documentCount), currentDoc(-1)
+{
+}
+
+bool AllDocsIterator::next()
+{
+    if (currentDoc == NO_MORE_DOCS) {
+        return false;
+    }
+    return advanceTo(currentDoc + 1);
+}
+
+bool AllDocsIterator::advanceTo(int target)
+{
+    if (target <= currentDoc) {
+        return currentDoc != NO_MORE_DOCS;
+    }
+    currentDoc = target < documentCount ? target : NO_MORE_DOCS;
+    return currentDoc != NO_MORE_DOCS;
+}
+
+AndIterator::AndIterator(const QVector<DocIterator*>& children)
+    : children(children), currentDoc(-1)
+{
+    std::sort(this->children.begin(), this->children.end(), [](DocIterator* a, DocIterator* b) {
+        return a->cost() < b->cost();
+    });
+}
+
+AndIterator::~AndIterator()
+{
+    qDeleteAll(children);
+}
+
+bool AndIterator::next()
+{
+    children.first()->next();
+    return alignFromLead();
+}
+
+bool AndIterator::advanceTo(int target)
+{
+    if (target <= currentDoc) {
+        return currentDoc != NO_MORE_DOCS;
+    }
+    children.first()->advanceTo(target);
+    return alignFromLead();
+}
+
+bool AndIterator::alignFromLead()
+{
+    DocIterator* lead = children.first();
+    int doc = lead->docId();
+
+    while (doc != NO_MORE_DOCS) {
+        bool matched = true;
+        for (int i = 1; i < children.size(); ++i) {
+            DocIterator* child = children[i];
+            if (child->docId() < doc) {
+                child->advanceTo(doc);
+            }
+            if (child->docId() > doc) {
+                // 其他表没有这个文档，领跑的表直接跳到对方的位置
+                lead->advanceTo(child->docId());
+                doc = lead->docId();
+                matched = false;
+                break;
+            }
+        }
+        if (matched) {
+            break;
+        }
+    }
+
+    currentDoc = doc;
+    return currentDoc != NO_MORE_DOCS;
+}
+
+namespace {
+    // 堆的比较函数，使堆顶为docId最小的子迭代器
+    bool laterDoc(DocIterator* a, DocIterator* b)
+    {
+        return a->docId() > b->docId();
+    }
+}
+
+OrIterator::OrIterator(const QVector<DocIterator*>& children)
+    : children(children), heap(children), currentDoc(-1), totalCost(0)
+{
+    for (DocIterator* child : children) {
+        totalCost += child->cost();
+    }
+    std::make_heap(heap.begin(), heap.end(), laterDoc);
+}
+
+OrIterator::~OrIterator()
+{
+    qDeleteAll(children);
+}
+
+bool OrIterator::next()
+{
+    if (currentDoc == NO_MORE_DOCS) {
+        return false;
+    }
+    return advanceTo(currentDoc + 1);
+}
+
+bool OrIterator::advanceTo(int target)
+{
+    if (target <= currentDoc) {
+        return currentDoc != NO_MORE_DOCS;
+    }
+
+    // 只移动落后于target的子迭代器，每次移动后重新放回堆中
+    while (heap.first()->docId() < target) {
+        std::pop_heap(heap.begin(), heap.end(), laterDoc);
+        heap.last()->advanceTo(target);
+        std::push_heap(heap.begin(), heap.end(), laterDoc);
+    }
+
+    currentDoc = heap.first()->docId();
+    return currentDoc != NO_MORE_DOCS;
+}
+
+AndNotIterator::AndNotIterator(DocIterator* include, DocIterator* exclude)
+    : include(include), exclude(exclude)
+{
+}
+
+AndNotIterator::~AndNotIterator()
+{
+    delete include;
+    delete exclude;
+}
+
+bool AndNotIterator::next()
+{
+    include->next();
+    return skipExcluded();
+}
+
+bool AndNotIterator::advanceTo(int target)
+{
+    if (target <= include->docId()) {
+        return include->docId() != NO_MORE_DOCS;
+    }
+    include->advanceTo(target);
+    return skipExcluded();
+}
+
+bool AndNotIterator::skipExcluded()
+{
+    while (include->docId() != NO_MORE_DOCS) {
+        int doc = include->docId();
+        if (exclude->docId() < doc) {
+            exclude->advanceTo(doc);
+        }
+        if (exclude->docId() != doc) {
+            return true;
+        }
+        include->next();
+    }
+    return false;
+}
+
+namespace {
+    template <typename T>
+    QVector<DocIterator*> toDocIterators(const QVector<T*>& iterators)
+    {
+        QVector<DocIterator*> result;
+        result.reserve(iterators.size());
+        for (T* it : iterators) {
+            result.append(it);
+        }
+        return result;
+    }
+}
+
+PhraseIterator::PhraseIterator(const QVector<TermDocIterator*>& terms, const QVector<int>& offsets)
+    : conjunction(new AndIterator(toDocIterators(terms))), terms(terms), offsets(offsets), phraseWidth(1)
+{
+    for (int offset : offsets) {
+        phraseWidth = qMax(phraseWidth, offset + 1);
+    }
+}
+
+PhraseIterator::~PhraseIterator()
+{
+    delete conjunction;
+}
+
+bool PhraseIterator::next()
+{
+    while (conjunction->next()) {
+        if (findMatches()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PhraseIterator::advanceTo(int target)
+{
+    if (target <= docId()) {
+        return docId() != NO_MORE_DOCS;
+    }
+    if (!conjunction->advanceTo(target)) {
+        return false;
+    }
+    return findMatches() || next();
+}
+
+bool PhraseIterator::findMatches()
+{
+    matches.clear();
+
+    QVector<QVector<int>> lists;
+    lists.reserve(terms.size());
+    for (TermDocIterator* term : terms) {
+        lists.append(term->positions());
+    }
+
+    // 以第一个词的每个位置为候选起点，其余各词的位置表用游标单调前移
+    QVector<int> cursor(terms.size(), 0);
+    for (int position : lists.first()) {
+        int start = position - offsets.first();
+        bool matched = true;
+        for (int i = 1; i < lists.size(); ++i) {
+            const QVector<int>& list = lists[i];
+            int wanted = start + offsets[i];
+            int& c = cursor[i];
+            while (c < list.size() && list[c] < wanted) {
+                ++c;
+            }
+            if (c == list.size()) {
+                return !matches.isEmpty();
+            }
+            if (list[c] != wanted) {
+                matched = false;
+                break;
+            }
+        }
+        if (matched) {
+            matches.append(start);
+        }
+    }
+    return !matches.isEmpty();
+}
+
+NearIterator::NearIterator(const QVector<PositionIterator*>& children, int distance)
+    : conjunction(new AndIterator(toDocIterators(children))), children(children), distance(distance)
+{
+}
+
+NearIterator::~NearIterator()
+{
+    delete conjunction;
+}
+
+bool NearIterator::next()
+{
+    while (conjunction->next()) {
+        if (withinDistance()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NearIterator::advanceTo(int target)
+{
+    if (target <= docId()) {
+        return docId() != NO_MORE_DOCS;
+    }
+    if (!conjunction->advanceTo(target)) {
+        return false;
+    }
+    return withinDistance() || next();
+}
+
+bool NearIterator::withinDistance()
+{
+    QVector<QVector<int>> lists;
+    lists.reserve(children.size());
+    for (PositionIterator* child : children) {
+        lists.append(child->positions());
+    }
+
+    // 每个子节点取一处匹配组成窗口，窗口不满足时前移终点最靠前的那一处：
+    // 含有它的任何窗口间隔都不会更小
+    QVector<int> cursor(children.size(), 0);
+    while (true) {
+        int maxStart = -1;
+        int minEnd = NO_MORE_DOCS;
+        int earliest = 0;
+        for (int i = 0; i < lists.size(); ++i) {
+            int start = lists[i][cursor[i]];
+            int end = start + children[i]->width() - 1;
+            maxStart = qMax(maxStart, start);
+            if (end < minEnd) {
+                minEnd = end;
+                earliest = i;
+            }
+        }
+        if (maxStart - minEnd <= distance) {
+            return true;
+        }
+        if (++cursor[earliest] == lists[earliest].size()) {
+            return false;
+        }
+    }
+}
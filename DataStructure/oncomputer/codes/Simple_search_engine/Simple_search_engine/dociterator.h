@@ -0,0 +1,162 @@
+#ifndef DOCITERATOR_H
+#define DOCITERATOR_H
+
+#include <QVector>
+#include <QtGlobal>
+#include "postinglist.h"
+
+// 按docId递增遍历匹配文档的迭代器，布尔查询的每个节点对应一个迭代器
+// 迭代器创建后位于-1，调用next()或advanceTo()后才指向第一个文档
+class DocIterator {
+public:
+    static const int NO_MORE_DOCS = PostingIterator::NO_MORE_DOCS;
+
+    virtual ~DocIterator() {}
+
+    virtual int docId() const = 0;
+    virtual bool next() = 0;                  // 移动到下一个匹配文档，没有更多文档时返回false
+    virtual bool advanceTo(int target) = 0;   // 移动到第一个docId >= target的匹配文档
+    virtual qint64 cost() const = 0;          // 估计的匹配文档数，用于决定求交的顺序
+};
+
+// 能给出当前文档中每处匹配位置的迭代器：单个词、短语
+class PositionIterator : public DocIterator {
+public:
+    virtual QVector<int> positions() = 0;   // 当前文档中每处匹配的起始位置，升序
+    virtual int width() const = 0;          // 每处匹配占用的词数
+};
+
+// 单个词的倒排表
+class TermDocIterator : public PositionIterator {
+public:
+    explicit TermDocIterator(const PostingView& postings = PostingView());
+
+    int docId() const override { return it.docId(); }
+    bool next() override { return it.next(); }
+    bool advanceTo(int target) override { return it.advanceTo(target); }
+    qint64 cost() const override { return documentFrequency; }
+    QVector<int> positions() override { return it.positions(); }
+    int width() const override { return 1; }
+
+    PostingIterator& postings() { return it; }   // 读取当前文档的词频和位置
+
+private:
+    PostingIterator it;
+    int documentFrequency;
+};
+
+// 全部文档 [0, documentCount)，用于只有NOT的查询
+class AllDocsIterator : public DocIterator {
+public:
+    explicit AllDocsIterator(int documentCount);
+
+    int docId() const override { return currentDoc; }
+    bool next() override;
+    bool advanceTo(int target) override;
+    qint64 cost() const override { return documentCount; }
+
+private:
+    int documentCount;
+    int currentDoc;
+};
+
+// 交集：按cost从小到大排列子迭代器，由最短的表领跑，其余子迭代器用advanceTo跳到候选文档，
+// 整个求交的代价接近最短的表的长度
+class AndIterator : public DocIterator {
+public:
+    explicit AndIterator(const QVector<DocIterator*>& children);   // 接管子迭代器
+    ~AndIterator() override;
+
+    int docId() const override { return currentDoc; }
+    bool next() override;
+    bool advanceTo(int target) override;
+    qint64 cost() const override { return children.first()->cost(); }
+
+private:
+    bool alignFromLead();
+
+    QVector<DocIterator*> children;
+    int currentDoc;
+};
+
+// 并集：子迭代器按当前docId组成最小堆，依次弹出最小的docId
+class OrIterator : public DocIterator {
+public:
+    explicit OrIterator(const QVector<DocIterator*>& children);    // 接管子迭代器
+    ~OrIterator() override;
+
+    int docId() const override { return currentDoc; }
+    bool next() override;
+    bool advanceTo(int target) override;
+    qint64 cost() const override { return totalCost; }
+
+private:
+    QVector<DocIterator*> children;
+    QVector<DocIterator*> heap;
+    int currentDoc;
+    qint64 totalCost;
+};
+
+// 差集：匹配include但不匹配exclude的文档
+class AndNotIterator : public DocIterator {
+public:
+    AndNotIterator(DocIterator* include, DocIterator* exclude);    // 接管子迭代器
+    ~AndNotIterator() override;
+
+    int docId() const override { return include->docId(); }
+    bool next() override;
+    bool advanceTo(int target) override;
+    qint64 cost() const override { return include->cost(); }
+
+private:
+    bool skipExcluded();
+
+    DocIterator* include;
+    DocIterator* exclude;
+};
+
+// 短语：先对各词求交，再检查位置——第i个词必须出现在 起点 + offsets[i]
+class PhraseIterator : public PositionIterator {
+public:
+    // 接管terms；offsets为各词相对第一个词的位置，第一个为0
+    PhraseIterator(const QVector<TermDocIterator*>& terms, const QVector<int>& offsets);
+    ~PhraseIterator() override;
+
+    int docId() const override { return conjunction->docId(); }
+    bool next() override;
+    bool advanceTo(int target) override;
+    qint64 cost() const override { return conjunction->cost(); }
+    QVector<int> positions() override { return matches; }
+    int width() const override { return phraseWidth; }
+
+private:
+    bool findMatches();
+
+    AndIterator* conjunction;
+    QVector<TermDocIterator*> terms;
+    QVector<int> offsets;
+    QVector<int> matches;       // 当前文档中短语的起始位置
+    int phraseWidth;
+};
+
+// 邻近：各子节点都出现，且能各取一处匹配，使它们之间的间隔不超过distance个词。
+// 间隔 = 最靠后的起点 - 最靠前的终点，两个单词时即为位置之差
+class NearIterator : public DocIterator {
+public:
+    NearIterator(const QVector<PositionIterator*>& children, int distance);   // 接管子迭代器
+    ~NearIterator() override;
+
+    int docId() const override { return conjunction->docId(); }
+    bool next() override;
+    bool advanceTo(int target) override;
+    qint64 cost() const override { return conjunction->cost(); }
+
+private:
+    bool withinDistance();
+
+    AndIterator* conjunction;
+    QVector<PositionIterator*> children;
+    int distance;
+};
+
+#endif // DOCITERATOR_H
@@ -0,0 +1,256 @@
+#include "documentreader.h"
+#include <QFile>
+#include <QtAlgorithms>
+#include <QtCore5Compat/QTextCodec>
+#include <atomic>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    // GB18030双字节字符：首字节0x81~0xFE，尾字节0x40~0xFE（不含0x7F）
+    const int GB_LEAD_COUNT = 0xFE - 0x81 + 1;
+    const int GB_TRAIL_COUNT = 0xFE - 0x40;
+    const int GB_TWO_BYTE_COUNT = GB_LEAD_COUNT * GB_TRAIL_COUNT;
+
+    std::atomic<qint64> decodedFiles[DocumentReader::EncodingCount];
+
+    QTextCodec* gb18030Codec()
+    {
+        // 在Qt6中使用core5compat模块中的QTextCodec处理中文编码
+        static QTextCodec* codec = QTextCodec::codecForName("GB18030");
+        return codec;
+    }
+
+    inline int gbIndex(uchar lead, uchar trail)
+    {
+        return (lead - 0x81) * GB_TRAIL_COUNT + trail - 0x40 - (trail > 0x7F ? 1 : 0);
+    }
+
+    // 双字节字符的UTF-16编码表，在第一次使用时用QTextCodec解码所有双字节字符得到；
+    // 0表示查不到，交给QTextCodec
+    const QVector<quint16>& gbTable()
+    {
+        static const QVector<quint16> table = []() {
+            QVector<quint16> result;
+            QTextCodec* codec = gb18030Codec();
+            if (!codec) {
+                return result;
+            }
+            QByteArray pairs;
+            pairs.reserve(GB_TWO_BYTE_COUNT * 2);
+            for (int lead = 0x81; lead <= 0xFE; ++lead) {
+                for (int trail = 0x40; trail <= 0xFE; ++trail) {
+                    if (trail != 0x7F) {
+                        pairs.append(static_cast<char>(lead));
+                        pairs.append(static_cast<char>(trail));
+                    }
+                }
+            }
+            result.resize(GB_TWO_BYTE_COUNT);
+            // 通常每个双字节字符解码为一个UTF-16单元，可以一次解码；否则逐个解码
+            QString all = codec->toUnicode(pairs);
+            for (int i = 0; i < GB_TWO_BYTE_COUNT; ++i) {
+                if (all.size() == GB_TWO_BYTE_COUNT) {
+                    result[i] = all.at(i).unicode();
+                } else {
+                    QString one = codec->toUnicode(pairs.constData() + 2 * i, 2);
+                    result[i] = one.size() == 1 ? one.at(0).unicode() : 0;
+                }
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    // 返回p之后第一个非ASCII字节的位置，一次检查一块字节的最高位
+    inline const uchar* skipAscii(const uchar* p, const uchar* end)
+    {
+#if defined(__AVX2__)
+        for (; end - p >= 32; p += 32) {
+            uint mask = static_cast<uint>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))));
+            if (mask) {
+                return p + qCountTrailingZeroBits(mask);
+            }
+        }
+#elif defined(__SSE2__)
+        for (; end - p >= 16; p += 16) {
+            uint mask = static_cast<uint>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+            if (mask) {
+                return p + qCountTrailingZeroBits(mask);
+            }
+        }
+#endif
+        while (p < end && *p < 0x80) {
+            ++p;
+        }
+        return p;
+    }
+
+    // 检查UTF-8编码是否有效（拒绝过长编码、代理区和超出范围的码点），ascii返回是否只有ASCII字符
+    bool validateUtf8(const uchar* p, const uchar* end, bool& ascii)
+    {
+        ascii = true;
+        while ((p = skipAscii(p, end)) < end) {
+            ascii = false;
+            uchar c = *p;
+            int length;
+            if (c >= 0xC2 && c <= 0xDF) {
+                length = 2;
+            } else if ((c & 0xF0) == 0xE0) {
+                length = 3;
+            } else if (c >= 0xF0 && c <= 0xF4) {
+                length = 4;
+            } else {
+                return false;
+            }
+            if (end - p < length) {
+                return false;
+            }
+            uint codePoint = c & (0x7F >> length);
+            for (int k = 1; k < length; ++k) {
+                if ((p[k] & 0xC0) != 0x80) {
+                    return false;
+                }
+                codePoint = (codePoint << 6) | (p[k] & 0x3F);
+            }
+            if ((length == 3 && (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF)))
+                || (length == 4 && (codePoint < 0x10000 || codePoint > 0x10FFFF))) {
+                return false;
+            }
+            p += length;
+        }
+        return true;
+    }
+
+    // 单字节和双字节字符查表解码，返回解码到的字节位置
+    qint64 decodeGb18030(const uchar* data, qint64 size, const QVector<quint16>& table, QString& result)
+    {
+        result.resize(size);
+        QChar* out = result.data();
+        const uchar* p = data;
+        const uchar* end = data + size;
+        while (p < end) {
+            if (*p < 0x80) {
+                const uchar* run = skipAscii(p, end);
+                for (; p < run; ++p) {
+                    *out++ = QChar(*p);
+                }
+                continue;
+            }
+            if (end - p < 2) {
+                break;
+            }
+            uchar lead = p[0];
+            uchar trail = p[1];
+            if (lead < 0x81 || lead > 0xFE || trail < 0x40 || trail > 0xFE || trail == 0x7F) {
+                break;
+            }
+            quint16 unit = table[gbIndex(lead, trail)];
+            if (!unit) {
+                break;
+            }
+            *out++ = QChar(unit);
+            p += 2;
+        }
+        result.resize(out - result.constData());
+        return p - data;
+    }
+}
+
+QString DocumentReader::decode(const QByteArray& data, Encoding* encoding)
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+    qint64 size = data.size();
+    Encoding used;
+    QString content;
+
+    // 有效的UTF-8通常不会是有意义的GB18030文本，GB18030文件在开头几个字节就能判断出不是UTF-8
+    bool ascii;
+    if (validateUtf8(bytes, bytes + size, ascii)) {
+        if (ascii) {
+            used = Ascii;
+            content = QString::fromLatin1(data);
+        } else {
+            used = Utf8;
+            bool bom = size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF;
+            content = bom ? QString::fromUtf8(data.constData() + 3, size - 3) : QString::fromUtf8(data);
+        }
+    } else if (!gb18030Codec()) {
+        used = Utf8;
+        content = QString::fromUtf8(data);
+    } else {
+        used = Gb18030;
+        qint64 decoded = decodeGb18030(bytes, size, gbTable(), content);
+        if (decoded < size) {
+            used = Gb18030Codec;
+            content += gb18030Codec()->toUnicode(data.constData() + decoded, static_cast<int>(size - decoded));
+        }
+    }
+
+    decodedFiles[used]++;
+    if (encoding) {
+        *encoding = used;
+    }
+    return content;
+}
+
+bool DocumentReader::read(const QString& filePath, QString& content)
+{
+    QByteArray data;
+    if (!readBytes(filePath, data)) {
+        return false;
+    }
+    content = decode(data);
+    return true;
+}
+
+bool DocumentReader::readBytes(const QString& filePath, QByteArray& data)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    data = file.readAll();
+    return true;
+}
+
+bool DocumentReader::isUtf8(const char* data, qint64 size)
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(data);
+    bool ascii;
+    return validateUtf8(bytes, bytes + size, ascii);
+}
+
+QVector<qint64> DocumentReader::encodingCounts()
+{
+    QVector<qint64> counts(EncodingCount);
+    for (int i = 0; i < EncodingCount; ++i) {
+        counts[i] = decodedFiles[i].load();
+    }
+    return counts;
+}
+
+void DocumentReader::resetEncodingCounts()
+{
+    for (int i = 0; i < EncodingCount; ++i) {
+        decodedFiles[i] = 0;
+    }
+}
+
+QString DocumentReader::encodingName(Encoding encoding)
+{
+    switch (encoding) {
+    case Ascii:
+        return "ASCII";
+    case Utf8:
+        return "UTF-8";
+    case Gb18030:
+        return "GB18030";
+    case Gb18030Codec:
+        return "GB18030(含四字节或无效字节)";
+    default:
+        return QString();
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef DOCUMENTREADER_H
+#define DOCUMENTREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// 读取导入的文本文件。语料中GB18030和UTF-8编码的文件混在一起：
+//   先检查是否为有效的UTF-8（纯ASCII按块跳过），是则按UTF-8解码；
+//   否则按GB18030解码，单字节和双字节字符查表，遇到四字节字符或无效字节时剩余部分交给QTextCodec。
+// 没有GB18030编码器时按UTF-8解码。
+// 界面程序、基准测试和压力测试程序都通过这里读取文档，可以在多个线程中同时调用
+class DocumentReader {
+public:
+    // 文件实际使用的解码方式
+    enum Encoding {
+        Ascii,              // 只有ASCII字符
+        Utf8,
+        Gb18030,            // 全部由查表解码
+        Gb18030Codec,       // 有四字节字符或无效字节，部分由QTextCodec解码
+        EncodingCount
+    };
+
+    static QString decode(const QByteArray& data, Encoding* encoding = nullptr);
+    static bool read(const QString& filePath, QString& content);   // 无法打开文件时返回false
+    static bool readBytes(const QString& filePath, QByteArray& data);   // 只读取，不解码
+
+    static bool isUtf8(const char* data, qint64 size);
+
+    // 从程序启动（或上次reset）以来按各种方式解码的文件数，下标为Encoding
+    static QVector<qint64> encodingCounts();
+    static void resetEncodingCounts();
+    static QString encodingName(Encoding encoding);
+};
+
+#endif // DOCUMENTREADER_H
@@ -0,0 +1,573 @@
+#include "incrementalindex.h"
+#include "ingestpipeline.h"
+#include "segmentmerger.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QSaveFile>
+#include <QSet>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+    const quint32 MANIFEST_MAGIC = 0x53534D46;   // "SSMF"
+    const quint32 MANIFEST_VERSION = 1;
+    const char* const MANIFEST_NAME = "manifest";
+}
+
+IncrementalIndex::IncrementalIndex()
+    : nextSegmentId(1), merging(false),
+      shards(qMax(1, QThread::idealThreadCount())), minShardDocuments(MIN_SHARD_DOCUMENTS),
+      bufferReader(&bufferIndex, &bufferStats, &bufferPaths)
+{
+}
+
+IncrementalIndex::~IncrementalIndex()
+{
+    close();
+}
+
+bool IncrementalIndex::open(const QString& directory, QString* errorMessage)
+{
+    close();
+
+    if (!QDir().mkpath(directory)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法创建索引目录 %1").arg(directory);
+        }
+        return false;
+    }
+    directoryPath = directory;
+
+    if (QFile::exists(segmentPath(MANIFEST_NAME)) && !loadManifest(errorMessage)) {
+        close();
+        return false;
+    }
+    removeUnusedFiles();
+    return true;
+}
+
+void IncrementalIndex::close()
+{
+    segments.clear();
+    files.clear();
+    locations.clear();
+    bufferIndex.clear();
+    bufferStats.clear();
+    bufferPaths.clear();
+    bufferDeleted = QBitArray();
+    directoryPath.clear();
+    nextSegmentId = 1;
+    merging = false;
+}
+
+FolderChanges IncrementalIndex::scanFolder(const QString& folderPath) const
+{
+    FolderChanges changes;
+    QDir directory(folderPath);
+    QString prefix = directory.absolutePath() + "/";
+
+    QSet<QString> present;
+    for (const QString& fileName : directory.entryList(QStringList() << "*.txt", QDir::Files)) {
+        QString path = prefix + fileName;
+        present.insert(path);
+
+        QFileInfo info(path);
+        FileState state;
+        state.size = info.size();
+        state.modified = info.lastModified().toMSecsSinceEpoch();
+
+        auto it = files.constFind(path);
+        if (it == files.constEnd() || it.value() != state) {
+            changes.added.append(path);
+            changes.states.insert(path, state);
+        }
+    }
+
+    // 只检查直接位于这个文件夹中的文件，其他文件夹导入的文件不受影响
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        const QString& path = it.key();
+        if (path.startsWith(prefix) && !path.mid(prefix.length()).contains('/') && !present.contains(path)) {
+            changes.removed.append(path);
+        }
+    }
+    return changes;
+}
+
+void IncrementalIndex::removeDocuments(const QStringList& paths)
+{
+    for (const QString& path : paths) {
+        files.remove(path);
+        auto it = locations.find(path);
+        if (it == locations.end()) {
+            continue;
+        }
+
+        const DocumentLocation& location = it.value();
+        if (!location.segment) {
+            bufferDeleted.setBit(location.docId);
+        } else {
+            for (LiveSegment& live : segments) {
+                if (live.segment.data() == location.segment) {
+                    live.deleted.setBit(location.docId);
+                    break;
+                }
+            }
+        }
+        locations.erase(it);
+    }
+}
+
+bool IncrementalIndex::addDocuments(const QList<IndexBatch>& batches, TermDictionary& dictionary,
+                                    const QVector<QString>& paths, const QHash<QString, FileState>& states,
+                                    QString* errorMessage)
+{
+    // 批次中的docId从0开始，内存段只能容纳一次导入
+    if (!bufferPaths.isEmpty() && !commit(errorMessage)) {
+        return false;
+    }
+
+    IndexBuilder::mergeBatches(batches, dictionary, bufferIndex, bufferStats);
+    bufferPaths = paths;
+    bufferDeleted = QBitArray(bufferStats.size());
+
+    for (int docId = 0; docId < paths.size(); ++docId) {
+        const QString& path = paths[docId];
+        // 修改过的文件先删除旧文档
+        removeDocuments(QStringList() << path);
+
+        DocumentLocation location = { nullptr, docId };
+        locations.insert(path, location);
+        files.insert(path, states.value(path));
+    }
+    return true;
+}
+
+bool IncrementalIndex::commit(QString* errorMessage)
+{
+    if (!bufferPaths.isEmpty()) {
+        QString name = QString("seg_%1.seg").arg(nextSegmentId++);
+        QSharedPointer<Segment> segment(new Segment());
+        if (!Segment::write(segmentPath(name), bufferReader, errorMessage)
+            || !segment->open(segmentPath(name), errorMessage)) {
+            QFile::remove(segmentPath(name));
+            return false;
+        }
+
+        for (auto it = locations.begin(); it != locations.end(); ++it) {
+            if (!it.value().segment) {
+                it.value().segment = segment.data();
+            }
+        }
+
+        LiveSegment live;
+        live.name = name;
+        live.segment = segment;
+        live.deleted = bufferDeleted;
+        segments.append(live);
+
+        bufferIndex.clear();
+        bufferStats.clear();
+        bufferPaths.clear();
+        bufferDeleted = QBitArray();
+    }
+    return saveManifest(errorMessage);
+}
+
+bool IncrementalIndex::importFolder(const QString& folderPath, QString* errorMessage,
+                                    const IndexBuilder::ProgressCallback& progress)
+{
+    FolderChanges changes = scanFolder(folderPath);
+    removeDocuments(changes.removed);
+
+    // 每部分导入后立即提交为一个段，内存中只保留一部分的倒排表，小段由后台合并；
+    // 每部分不超过一个分片的文档数
+    int imported = 0;
+    const int total = changes.added.size();
+    const QList<QStringList> parts = IngestPipeline::split(changes.added, changes.states,
+                                                           IngestPipeline::DEFAULT_PART_BYTES,
+                                                           shardDocuments(total));
+    for (const QStringList& part : parts) {
+        TermDictionary dictionary;
+        IngestResult result = IngestPipeline::run(part, dictionary,
+            [&progress, imported, total](int value, int, const QString&) {
+                if (progress) {
+                    progress(imported + value, total,
+                             QString("正在构建索引... (%1/%2)").arg(imported + value).arg(total));
+                }
+            });
+        imported += part.size();
+        if (!result.paths.isEmpty()
+            && (!addDocuments(result.batches, dictionary, result.paths, changes.states, errorMessage)
+                || !commit(errorMessage))) {
+            return false;
+        }
+    }
+    return commit(errorMessage);
+}
+
+QVector<SearchSegment> IncrementalIndex::searchSegments() const
+{
+    QVector<SearchSegment> result;
+    int docBase = 0;
+    for (const LiveSegment& live : segments) {
+        SearchSegment segment;
+        segment.reader = live.segment.data();
+        segment.docBase = docBase;
+        segment.deleted = live.deleted;
+        result.append(segment);
+        docBase += live.segment->documentCount();
+    }
+    if (!bufferPaths.isEmpty()) {
+        SearchSegment segment;
+        segment.reader = &bufferReader;
+        segment.docBase = docBase;
+        segment.deleted = bufferDeleted;
+        result.append(segment);
+    }
+    return result;
+}
+
+int IncrementalIndex::documentCount() const
+{
+    int count = bufferPaths.size();
+    for (const LiveSegment& live : segments) {
+        count += live.segment->documentCount();
+    }
+    return count;
+}
+
+qint64 IncrementalIndex::fileSize() const
+{
+    qint64 size = 0;
+    for (const LiveSegment& live : segments) {
+        size += live.segment->fileSize();
+    }
+    return size;
+}
+
+int IncrementalIndex::liveDocumentCount() const
+{
+    return locations.size();
+}
+
+void IncrementalIndex::setShardCount(int count, int minDocuments)
+{
+    shards = qMax(1, count);
+    minShardDocuments = qMax(1, minDocuments);
+}
+
+int IncrementalIndex::shardDocuments(int pendingDocuments) const
+{
+    qint64 total = qint64(liveDocumentCount()) + pendingDocuments;
+    return static_cast<int>(qMax<qint64>(minShardDocuments, (total + shards - 1) / shards));
+}
+
+const IndexReader* IncrementalIndex::locate(int docId, int& localId) const
+{
+    localId = docId;
+    for (const LiveSegment& live : segments) {
+        if (localId < live.segment->documentCount()) {
+            return live.segment.data();
+        }
+        localId -= live.segment->documentCount();
+    }
+    return localId < bufferPaths.size() ? &bufferReader : nullptr;
+}
+
+QString IncrementalIndex::documentPath(int docId) const
+{
+    int localId;
+    const IndexReader* reader = locate(docId, localId);
+    return reader ? reader->documentPath(localId) : QString();
+}
+
+TokenSpan IncrementalIndex::tokenSpan(int docId, int first, int count) const
+{
+    int localId;
+    const IndexReader* reader = locate(docId, localId);
+    return reader ? reader->tokenSpan(localId, first, count) : TokenSpan(-1, 0);
+}
+
+bool IncrementalIndex::planMerge(MergeTask& task)
+{
+    if (merging) {
+        return false;
+    }
+
+    QVector<int> inputs;
+
+    // 删除比例过高的段单独重写，清除已删除的文档
+    for (int i = 0; i < segments.size() && inputs.isEmpty(); ++i) {
+        qint64 total = segments[i].segment->documentCount();
+        qint64 removed = segments[i].deleted.count(true);
+        if (total > 0 && removed * 100 > total * MAX_DELETED_PERCENT) {
+            inputs.append(i);
+        }
+    }
+
+    // 按有效文档数分层，从最低层开始找有MERGE_FACTOR个段的层；
+    // 已经达到分片上限的段不再合并，合并结果也不超过上限
+    if (inputs.isEmpty()) {
+        const int shardLimit = shardDocuments();
+        QMap<int, QVector<int>> levels;
+        QVector<int> lives(segments.size());
+        for (int i = 0; i < segments.size(); ++i) {
+            int live = segments[i].segment->documentCount() - segments[i].deleted.count(true);
+            lives[i] = live;
+            if (live >= shardLimit) {
+                continue;
+            }
+            int level = 0;
+            while (live >= MERGE_FACTOR) {
+                live /= MERGE_FACTOR;
+                level++;
+            }
+            levels[level].append(i);
+        }
+        for (auto it = levels.constBegin(); it != levels.constEnd() && inputs.isEmpty(); ++it) {
+            if (it.value().size() < MERGE_FACTOR) {
+                continue;
+            }
+            qint64 total = 0;
+            for (int i : it.value()) {
+                if (inputs.size() < MERGE_FACTOR && total + lives[i] <= shardLimit) {
+                    inputs.append(i);
+                    total += lives[i];
+                }
+            }
+            if (inputs.size() < 2) {
+                inputs.clear();
+            }
+        }
+    }
+
+    if (inputs.isEmpty()) {
+        return false;
+    }
+
+    task = MergeTask();
+    for (int i : inputs) {
+        task.inputs.append(segments[i].segment);
+        task.deleted.append(segments[i].deleted);
+    }
+    task.outputName = QString("seg_%1.seg").arg(nextSegmentId++);
+    task.outputPath = segmentPath(task.outputName);
+    merging = true;
+    return true;
+}
+
+MergeResult IncrementalIndex::runMerge(const MergeTask& task)
+{
+    MergeResult result;
+    result.task = task;
+
+    QVector<const Segment*> inputs;
+    for (const QSharedPointer<Segment>& segment : task.inputs) {
+        inputs.append(segment.data());
+    }
+    result.ok = SegmentMerger::merge(inputs, task.deleted, task.outputPath, &result.docMaps, &result.errorMessage);
+    return result;
+}
+
+bool IncrementalIndex::installMerge(const MergeResult& result, QString* errorMessage)
+{
+    merging = false;
+    const MergeTask& task = result.task;
+
+    auto fail = [&](const QString& message) {
+        QFile::remove(task.outputPath);
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    if (!result.ok) {
+        return fail(result.errorMessage);
+    }
+
+    // 找到输入段当前的位置；索引在合并期间被关闭或重新打开时放弃这次合并
+    QVector<int> indexes;
+    for (const QSharedPointer<Segment>& input : task.inputs) {
+        int found = -1;
+        for (int i = 0; i < segments.size(); ++i) {
+            if (segments[i].segment == input) {
+                found = i;
+                break;
+            }
+        }
+        if (found < 0) {
+            return fail("合并的输入段已不存在");
+        }
+        indexes.append(found);
+    }
+
+    QSharedPointer<Segment> merged(new Segment());
+    QString openError;
+    if (!merged->open(task.outputPath, &openError)) {
+        return fail(openError);
+    }
+
+    // 合并期间新增的删除标记转到新段上
+    QBitArray deleted(merged->documentCount());
+    for (int k = 0; k < indexes.size(); ++k) {
+        const QBitArray& now = segments[indexes[k]].deleted;
+        const QBitArray& before = task.deleted[k];
+        const QVector<int>& docMap = result.docMaps[k];
+        for (int docId = 0; docId < now.size(); ++docId) {
+            if (now.testBit(docId) && !before.testBit(docId) && docMap[docId] >= 0) {
+                deleted.setBit(docMap[docId]);
+            }
+        }
+    }
+
+    for (auto it = locations.begin(); it != locations.end(); ++it) {
+        DocumentLocation& location = it.value();
+        for (int k = 0; k < task.inputs.size(); ++k) {
+            if (location.segment == task.inputs[k].data()) {
+                location.segment = merged.data();
+                location.docId = result.docMaps[k][location.docId];
+                break;
+            }
+        }
+    }
+
+    // 新段放在第一个输入段的位置，其余输入段移除
+    QStringList oldNames;
+    for (int i : indexes) {
+        oldNames.append(segments[i].name);
+    }
+    std::sort(indexes.begin(), indexes.end());
+    LiveSegment live;
+    live.name = task.outputName;
+    live.segment = merged;
+    live.deleted = deleted;
+    segments[indexes.first()] = live;
+    for (int k = indexes.size() - 1; k > 0; --k) {
+        segments.remove(indexes[k]);
+    }
+
+    // manifest保存成功后旧段才不再被引用，此时才能删除
+    if (!saveManifest(errorMessage)) {
+        return false;
+    }
+    for (const QSharedPointer<Segment>& input : task.inputs) {
+        input->close();
+    }
+    for (const QString& name : oldNames) {
+        QFile::remove(segmentPath(name));
+    }
+    return true;
+}
+
+bool IncrementalIndex::loadManifest(QString* errorMessage)
+{
+    QFile file(segmentPath(MANIFEST_NAME));
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法读取索引清单: %1").arg(file.errorString());
+        }
+        return false;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != MANIFEST_MAGIC || version != MANIFEST_VERSION) {
+        if (errorMessage) {
+            *errorMessage = "索引清单的格式不正确";
+        }
+        return false;
+    }
+
+    quint32 segmentCount = 0;
+    in >> nextSegmentId >> segmentCount;
+    for (quint32 i = 0; i < segmentCount && in.status() == QDataStream::Ok; ++i) {
+        LiveSegment live;
+        in >> live.name >> live.deleted;
+
+        live.segment = QSharedPointer<Segment>(new Segment());
+        if (!live.segment->open(segmentPath(live.name), errorMessage)) {
+            return false;
+        }
+        live.deleted.resize(live.segment->documentCount());
+
+        for (int docId = 0; docId < live.segment->documentCount(); ++docId) {
+            if (!live.deleted.testBit(docId)) {
+                DocumentLocation location = { live.segment.data(), docId };
+                locations.insert(live.segment->documentPath(docId), location);
+            }
+        }
+        segments.append(live);
+    }
+
+    quint32 fileCount = 0;
+    in >> fileCount;
+    for (quint32 i = 0; i < fileCount && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        FileState state;
+        in >> path >> state.size >> state.modified;
+        files.insert(path, state);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        if (errorMessage) {
+            *errorMessage = "索引清单已损坏";
+        }
+        return false;
+    }
+    return true;
+}
+
+bool IncrementalIndex::saveManifest(QString* errorMessage)
+{
+    QSaveFile file(segmentPath(MANIFEST_NAME));
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法写入索引清单: %1").arg(file.errorString());
+        }
+        return false;
+    }
+
+    QDataStream out(&file);
+    out << MANIFEST_MAGIC << MANIFEST_VERSION << nextSegmentId << quint32(segments.size());
+    for (const LiveSegment& live : segments) {
+        out << live.name << live.deleted;
+    }
+    out << quint32(files.size());
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        out << it.key() << it.value().size << it.value().modified;
+    }
+
+    if (!file.commit()) {
+        if (errorMessage) {
+            *errorMessage = QString("无法写入索引清单: %1").arg(file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+void IncrementalIndex::removeUnusedFiles()
+{
+    // 清理写出后没来得及记入清单的段（例如合并时程序退出）
+    QSet<QString> used;
+    for (const LiveSegment& live : segments) {
+        used.insert(live.name);
+    }
+    QDir directory(directoryPath);
+    for (const QString& name : directory.entryList(QStringList() << "seg_*.seg", QDir::Files)) {
+        if (!used.contains(name)) {
+            QFile::remove(directory.filePath(name));
+        }
+    }
+}
+
+QString IncrementalIndex::segmentPath(const QString& name) const
+{
+    return directoryPath + "/" + name;
+}
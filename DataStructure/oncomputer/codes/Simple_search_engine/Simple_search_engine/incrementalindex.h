@@ -0,0 +1,144 @@
+#ifndef INCREMENTALINDEX_H
+#define INCREMENTALINDEX_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "indexbuilder.h"
+#include "indexreader.h"
+#include "segment.h"
+#include "skiplist.h"
+
+// 文件的大小和修改时间，用来判断导入文件夹中的文件是否变化
+struct FileState {
+    qint64 size = 0;
+    qint64 modified = 0;     // 修改时间（毫秒）
+
+    bool operator==(const FileState& other) const { return size == other.size && modified == other.modified; }
+    bool operator!=(const FileState& other) const { return !(*this == other); }
+};
+
+// 导入文件夹相对索引的变化
+struct FolderChanges {
+    QStringList added;                  // 新增或已修改的文件，需要（重新）建立索引
+    QStringList removed;                // 已从文件夹中删除的文件
+    QHash<QString, FileState> states;   // added中各文件的当前状态
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty(); }
+};
+
+// 一次后台合并：输入段、开始合并时的删除标记和输出文件
+struct MergeTask {
+    QVector<QSharedPointer<Segment>> inputs;
+    QVector<QBitArray> deleted;
+    QString outputName;
+    QString outputPath;
+};
+
+struct MergeResult {
+    MergeTask task;
+    QVector<QVector<int>> docMaps;      // 输入段的旧docId -> 合并后的docId
+    bool ok = false;
+    QString errorMessage;
+};
+
+// 增量索引（LSM结构）
+//   新增或修改的文件先建立在内存段中，提交时写出为不可变的段文件；
+//   删除和修改通过删除标记实现，不改动已有的段；
+//   同一层（文档数在 MERGE_FACTOR^k 到 MERGE_FACTOR^(k+1) 之间）的段达到MERGE_FACTOR个时，
+//   在后台把它们合并为一个，删除比例过高的段单独重写，合并时清除已删除的文档。
+//   段列表、删除标记和文件状态保存在索引目录的manifest文件里。
+//   段同时是查询的分片：有效文档数达到分片上限（有效文档总数 / 分片数，不少于MIN_SHARD_DOCUMENTS）
+//   的段不再参与分层合并，导入时每部分也不超过这个文档数，大索引保持约shardCount个段供并行查询。
+//   查询时各段的docId依次排列，第i个段的docBase为前面各段的文档数之和
+class IncrementalIndex {
+public:
+    static const int MERGE_FACTOR = 4;
+    static const int MAX_DELETED_PERCENT = 30;
+    static const int MIN_SHARD_DOCUMENTS = 10000;
+
+    IncrementalIndex();
+    ~IncrementalIndex();
+
+    bool open(const QString& directory, QString* errorMessage = nullptr);   // 打开或创建索引目录
+    void close();
+    bool isOpen() const { return !directoryPath.isEmpty(); }
+
+    // 对比文件夹中的txt文件与索引中记录的大小和修改时间
+    FolderChanges scanFolder(const QString& folderPath) const;
+
+    void removeDocuments(const QStringList& paths);   // 标记删除，不在索引中的路径忽略
+    // 把一次导入的批次结果和词典加入内存段，paths[i]为批次中docId为i的文档；
+    // 内存段中还有上次未能提交的文档时先提交
+    bool addDocuments(const QList<IndexBatch>& batches, TermDictionary& dictionary,
+                      const QVector<QString>& paths, const QHash<QString, FileState>& states,
+                      QString* errorMessage = nullptr);
+    bool commit(QString* errorMessage = nullptr);     // 把内存段写成段文件并保存manifest
+
+    // 同步导入文件夹：删除已不存在的文件，用IngestPipeline分部分为新增或修改的文件建立索引，
+    // 每部分提交一次。供命令行工具使用；界面程序分步异步执行同样的过程以便显示进度
+    bool importFolder(const QString& folderPath, QString* errorMessage = nullptr,
+                      const IndexBuilder::ProgressCallback& progress = IndexBuilder::ProgressCallback());
+
+    // 分片数默认为CPU核数；minDocuments为每个分片文档数上限的下限，文档较少时不拆分
+    void setShardCount(int count, int minDocuments = MIN_SHARD_DOCUMENTS);
+    int shardCount() const { return shards; }
+    // 再加入pendingDocuments个文档后每个分片的文档数上限
+    int shardDocuments(int pendingDocuments = 0) const;
+
+    QVector<SearchSegment> searchSegments() const;    // 查询用的段列表，包括未提交的内存段
+    int documentCount() const;                        // 全局docId的上界，包括已删除的文档
+    int liveDocumentCount() const;
+    int segmentCount() const { return segments.size(); }
+    qint64 fileSize() const;                          // 各段文件的总字节数
+    QString documentPath(int docId) const;            // 按全局docId
+    TokenSpan tokenSpan(int docId, int first, int count = 1) const;
+
+    // 合并分三步：planMerge在调用线程中选出输入段，runMerge在后台线程写出新段，
+    // installMerge回到调用线程用新段替换输入段，合并期间新增的删除标记会转到新段上
+    bool planMerge(MergeTask& task);
+    static MergeResult runMerge(const MergeTask& task);
+    bool installMerge(const MergeResult& result, QString* errorMessage = nullptr);
+    bool isMerging() const { return merging; }
+
+private:
+    struct LiveSegment {
+        QString name;
+        QSharedPointer<Segment> segment;
+        QBitArray deleted;
+    };
+
+    // 文档所在的段，segment为空表示在内存段中
+    struct DocumentLocation {
+        const Segment* segment;
+        int docId;
+    };
+
+    bool loadManifest(QString* errorMessage);
+    bool saveManifest(QString* errorMessage);
+    void removeUnusedFiles();
+    const IndexReader* locate(int docId, int& localId) const;
+    QString segmentPath(const QString& name) const;
+
+    QString directoryPath;
+    quint32 nextSegmentId;
+    QVector<LiveSegment> segments;
+    QHash<QString, FileState> files;                  // 已建立索引的文件
+    QHash<QString, DocumentLocation> locations;       // 文件路径 -> 所在的段和docId
+    bool merging;
+    int shards;
+    int minShardDocuments;
+
+    // 内存段
+    SkipList bufferIndex;
+    QVector<DocumentStats> bufferStats;
+    QVector<QString> bufferPaths;
+    QBitArray bufferDeleted;
+    MemoryIndexReader bufferReader;
+};
+
+#endif // INCREMENTALINDEX_H
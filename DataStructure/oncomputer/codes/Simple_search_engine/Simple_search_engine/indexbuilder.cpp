@@ -0,0 +1,206 @@
+#include "indexbuilder.h"
+#include "tokenizer.h"
+
+namespace {
+    // 批次内的词表：以词在原文中第一次出现的区间代表这个词，按哈希值开放寻址，
+    // 查找时直接比较原文中的字符，每个词只在批次结束时生成一次QString
+    class BatchTermTable {
+    public:
+        struct Entry {
+            const QString* text = nullptr;   // 第一次出现所在的文档
+            Token token;
+            int lastDoc = -1;                // 最后出现的文档
+            int local = 0;                   // 在最后出现的文档中的编号
+            PostingList postings;
+        };
+
+        BatchTermTable() : buckets(INITIAL_BUCKETS, -1) {}
+
+        int findOrInsert(const QString& text, const Token& token)
+        {
+            int mask = buckets.size() - 1;
+            for (int i = token.hash & mask; ; i = (i + 1) & mask) {
+                int index = buckets[i];
+                if (index < 0) {
+                    Entry entry;
+                    entry.text = &text;
+                    entry.token = token;
+                    entries.append(entry);
+                    buckets[i] = entries.size() - 1;
+                    if (entries.size() * 2 > buckets.size()) {
+                        grow();
+                    }
+                    return entries.size() - 1;
+                }
+                const Entry& entry = entries[index];
+                if (Tokenizer::sameTerm(*entry.text, entry.token, text, token)) {
+                    return index;
+                }
+            }
+        }
+
+        QVector<Entry> entries;
+
+    private:
+        static const int INITIAL_BUCKETS = 4096;   // 必须是2的幂
+
+        void grow()
+        {
+            QVector<int> larger(buckets.size() * 2, -1);
+            int mask = larger.size() - 1;
+            for (int index = 0; index < entries.size(); ++index) {
+                int i = entries[index].token.hash & mask;
+                while (larger[i] >= 0) {
+                    i = (i + 1) & mask;
+                }
+                larger[i] = index;
+            }
+            buckets.swap(larger);
+        }
+
+        QVector<int> buckets;
+    };
+}
+
+QList<BatchRange> IndexBuilder::makeBatches(int totalDocuments, int batchSize)
+{
+    QList<BatchRange> batches;
+    int numBatches = (totalDocuments + batchSize - 1) / batchSize;
+
+    for (int i = 0; i < numBatches; ++i) {
+        int start = i * batchSize;
+        int end = qMin((i + 1) * batchSize, totalDocuments);
+        batches.append(BatchRange(start, end));
+    }
+
+    return batches;
+}
+
+IndexBatch IndexBuilder::processBatch(const QVector<QString>& contents, const BatchRange& range,
+                                      TermDictionary& dictionary, const ProgressCallback& progress)
+{
+    return processDocuments(contents.constData() + range.start, range.end - range.start, range.start,
+                            contents.size(), dictionary, progress);
+}
+
+IndexBatch IndexBuilder::processBatch(const QVector<QString>& contents, int firstDocId,
+                                      TermDictionary& dictionary)
+{
+    return processDocuments(contents.constData(), contents.size(), firstDocId,
+                            firstDocId + contents.size(), dictionary, ProgressCallback());
+}
+
+IndexBatch IndexBuilder::processDocuments(const QString* documents, int count, int firstDocId,
+                                          int totalDocuments, TermDictionary& dictionary,
+                                          const ProgressCallback& progress)
+{
+    IndexBatch batch;
+    batch.firstDocId = firstDocId;
+    batch.documentStats.resize(count);
+    BatchTermTable terms;
+
+    // 计算这个批次中所有文档的总字符数
+    qint64 totalChars = 0;
+    for (int i = 0; i < count; ++i) {
+        totalChars += documents[i].length();
+    }
+    qint64 processedChars = 0;
+
+    // 文档内的临时数组在批次内复用：每个词位置上的词编号、各词的出现次数和分组后的位置
+    QVector<int> tokenTerms;
+    QVector<int> docTerms;
+    QVector<int> starts;
+    QVector<int> ends;
+    QVector<int> positions;
+
+    // 处理这个批次中的所有文档，每个文档只分词一次，不为单个词分配字符串
+    for (int i = 0; i < count; ++i) {
+        const int docId = firstDocId + i;
+        const QString& content = documents[i];
+        DocumentStats& stats = batch.documentStats[i];
+        tokenTerms.clear();
+        docTerms.clear();
+        ends.clear();
+
+        Tokenizer::tokenize(content, [&](const Token& token) {
+            stats.tokenOffsets.append(token.start, token.length);
+            int index = terms.findOrInsert(content, token);
+            BatchTermTable::Entry& entry = terms.entries[index];
+            if (entry.lastDoc != docId) {
+                entry.lastDoc = docId;
+                entry.local = docTerms.size();
+                docTerms.append(index);
+                ends.append(0);
+            }
+            ends[entry.local]++;
+            tokenTerms.append(entry.local);
+        });
+        stats.tokenOffsets.finish();
+        stats.tokenCount = tokenTerms.size();
+
+        // 按词分组各位置（计数排序），每个词的位置保持升序，docId递增，可以直接追加到压缩倒排表
+        starts.resize(docTerms.size());
+        int sum = 0;
+        for (int local = 0; local < docTerms.size(); ++local) {
+            starts[local] = sum;
+            sum += ends[local];
+            ends[local] = starts[local];
+        }
+        positions.resize(tokenTerms.size());
+        for (int pos = 0; pos < tokenTerms.size(); ++pos) {
+            positions[ends[tokenTerms[pos]]++] = pos;
+        }
+        for (int local = 0; local < docTerms.size(); ++local) {
+            terms.entries[docTerms[local]].postings.add(docId, positions.constData() + starts[local],
+                                                        ends[local] - starts[local]);
+        }
+
+        // 更新进度（基于处理的字符数）
+        processedChars += content.length();
+        if (progress) {
+            double ratio = totalChars > 0 ? static_cast<double>(processedChars) / totalChars : 1.0;
+            progress(docId + 1, totalDocuments,
+                     QString("正在构建索引... 批次进度: %1% (%2/%3)")
+                         .arg(qRound(ratio * 100))
+                         .arg(i + 1)
+                         .arg(count));
+        }
+    }
+
+    // 批次的倒排表直接加入共享词典，不需要排序
+    QVector<InvertedIndexNode> batchTerms;
+    batchTerms.reserve(terms.entries.size());
+    for (BatchTermTable::Entry& entry : terms.entries) {
+        InvertedIndexNode node(Tokenizer::termText(*entry.text, entry.token));
+        entry.postings.finish();
+        node.postings = entry.postings;
+        batchTerms.append(node);
+    }
+    dictionary.add(firstDocId, batchTerms);
+
+    if (progress) {
+        progress(firstDocId + count, totalDocuments,
+                 QString("正在构建索引... 处理词条: %1").arg(batchTerms.size()));
+    }
+
+    return batch;
+}
+
+void IndexBuilder::mergeBatches(const QList<IndexBatch>& results, TermDictionary& dictionary,
+                                SkipList& index, QVector<DocumentStats>& documentStats)
+{
+    // 汇总各批次的文档统计信息
+    int totalDocuments = 0;
+    for (const IndexBatch& batch : results) {
+        totalDocuments = qMax(totalDocuments, batch.firstDocId + static_cast<int>(batch.documentStats.size()));
+    }
+    documentStats.resize(totalDocuments);
+    for (const IndexBatch& batch : results) {
+        for (int i = 0; i < batch.documentStats.size(); ++i) {
+            documentStats[batch.firstDocId + i] = batch.documentStats[i];
+        }
+    }
+
+    // 同一关键词的各批次倒排表在词典中按docId拼接，再按关键词升序写入跳表
+    dictionary.freeze(index);
+}
@@ -0,0 +1,63 @@
+#ifndef INDEXBUILDER_H
+#define INDEXBUILDER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <functional>
+#include "invertedindexnode.h"
+#include "skiplist.h"
+#include "termdictionary.h"
+#include "tokenoffsettable.h"
+
+// 文档统计信息，分词时一次性计算并缓存，建索引和生成摘要时不再重复分词
+struct DocumentStats {
+    int tokenCount = 0;              // 文档的词数
+    TokenOffsetTable tokenOffsets;   // 第i个词在原文中的位置（压缩存储）
+};
+
+// 批次的倒排表直接加入TermDictionary，批次结果中只保留文档统计信息
+struct IndexBatch {
+    int firstDocId = 0;                  // 批次中第一个文档的ID
+    QVector<DocumentStats> documentStats; // 批次中每个文档的统计信息
+};
+
+struct BatchRange {
+    int start;
+    int end;
+    BatchRange(int s, int e) : start(s), end(e) {}
+};
+
+// 索引构建器：分词、按批次建立倒排表并合并，不依赖任何界面组件
+class IndexBuilder {
+public:
+    static const int BATCH_SIZE = 20;
+
+    // 进度回调：当前值、最大值、提示信息
+    typedef std::function<void(int, int, const QString&)> ProgressCallback;
+
+    static QList<BatchRange> makeBatches(int totalDocuments, int batchSize = BATCH_SIZE);
+
+    // 处理一个批次：每个文档只分词一次，倒排表加入dictionary，返回文档统计信息。
+    // 可以在多个线程中同时处理不同批次
+    static IndexBatch processBatch(const QVector<QString>& contents, const BatchRange& range,
+                                   TermDictionary& dictionary,
+                                   const ProgressCallback& progress = ProgressCallback());
+    // 同上，contents只包含这个批次的文档，第一个文档的docId为firstDocId；
+    // 流式导入时批次的原文在返回后即可释放
+    static IndexBatch processBatch(const QVector<QString>& contents, int firstDocId,
+                                   TermDictionary& dictionary);
+
+    // 冻结词典写入跳表，并按docId汇总各批次的文档统计信息
+    static void mergeBatches(const QList<IndexBatch>& results, TermDictionary& dictionary,
+                             SkipList& index, QVector<DocumentStats>& documentStats);
+
+private:
+    // documents[i]的docId为firstDocId + i，totalDocuments只用于显示进度
+    static IndexBatch processDocuments(const QString* documents, int count, int firstDocId,
+                                       int totalDocuments, TermDictionary& dictionary,
+                                       const ProgressCallback& progress);
+};
+
+#endif // INDEXBUILDER_H
@@ -0,0 +1,140 @@
+#include "indexreader.h"
+#include "tokenizer.h"
+#include "wildcard.h"
+#include <algorithm>
+
+namespace {
+    // 自动机与词典求交的深度优先遍历
+    class FuzzyWalker {
+    public:
+        FuzzyWalker(const IndexReader& reader, const LevenshteinAutomaton& automaton,
+                    const IndexReader::FuzzyVisitor& visitor)
+            : reader(reader), automaton(automaton), visitor(visitor), skipChinese(false)
+        {
+            // 索引词要么全是中文要么没有中文；查询词没有中文且长于允许的编辑次数时，
+            // 与任何中文词的距离都超过maxEdits，中文字符整段跳过
+            const QString& term = automaton.term();
+            skipChinese = term.length() > automaton.maxEdits();
+            for (const QChar& ch : term) {
+                skipChinese = skipChinese && !Tokenizer::isChinese(ch.unicode());
+            }
+        }
+
+        void run()
+        {
+            QVector<int> row(automaton.rowSize());
+            automaton.start(row.data());
+            QString first = reader.ceilingTerm(QString());
+            if (!first.isEmpty()) {
+                visit(QString(), row.constData(), first);
+            }
+        }
+
+    private:
+        // row为读入prefix后的状态，term为词典中第一个以prefix开头的词
+        void visit(const QString& prefix, const int* row, QString term)
+        {
+            const int depth = prefix.length();
+            if (term.length() == depth) {
+                if (automaton.isMatch(row)) {
+                    visitor(term, automaton.distance(row), reader.postings(term));
+                }
+                term = reader.ceilingTerm(prefix + QChar(ushort(0)));
+            }
+
+            // 读入不在查询词中的字符就不可能被接受时，只有查询词中的字符值得尝试
+            QVector<int> next(automaton.rowSize());
+            const bool otherAlive = automaton.stepOther(row, next.data()) <= automaton.maxEdits();
+            const QVector<ushort>& alphabet = automaton.characters();
+
+            while (!term.isEmpty() && term.startsWith(prefix)) {
+                ushort ch = term.at(depth).unicode();
+                if (skipChinese && Tokenizer::isChinese(ch)) {
+                    term = reader.ceilingTerm(prefix + QChar(ushort(0x9FFF + 1)));
+                    continue;
+                }
+                if (!otherAlive) {
+                    auto candidate = std::lower_bound(alphabet.constBegin(), alphabet.constEnd(), ch);
+                    if (candidate == alphabet.constEnd()) {
+                        return;
+                    }
+                    if (*candidate != ch) {
+                        term = reader.ceilingTerm(prefix + QChar(*candidate));
+                        continue;
+                    }
+                }
+
+                if (automaton.step(row, ch, next.data()) <= automaton.maxEdits()) {
+                    visit(prefix + QChar(ch), next.constData(), term);
+                }
+                if (ch == 0xFFFF) {
+                    return;
+                }
+                term = reader.ceilingTerm(prefix + QChar(ushort(ch + 1)));
+            }
+        }
+
+        const IndexReader& reader;
+        const LevenshteinAutomaton& automaton;
+        const IndexReader::FuzzyVisitor& visitor;
+        bool skipChinese;
+    };
+}
+
+void IndexReader::forEachFuzzyTerm(const LevenshteinAutomaton& automaton, const FuzzyVisitor& visitor) const
+{
+    FuzzyWalker(*this, automaton, visitor).run();
+}
+
+void IndexReader::forEachWildcardTerm(const QString& pattern, const TermVisitor& visitor) const
+{
+    // 匹配的词都以模式中第一个通配符之前的部分开头
+    forEachTermWithPrefix(Wildcard::literalPrefix(pattern), [&pattern, &visitor](const QString& term,
+                                                                                 const PostingView& postings) {
+        if (Wildcard::matches(pattern, term)) {
+            visitor(term, postings);
+        }
+    });
+}
+
+MemoryIndexReader::MemoryIndexReader(const SkipList* index, const QVector<DocumentStats>* documentStats,
+                                     const QVector<QString>* documentPaths)
+    : index(index), documentStats(documentStats), documentPaths(documentPaths)
+{
+}
+
+QString MemoryIndexReader::documentPath(int docId) const
+{
+    return docId < documentPaths->size() ? (*documentPaths)[docId] : QString();
+}
+
+PostingView MemoryIndexReader::postings(const QString& term) const
+{
+    const InvertedIndexNode* node = index->find(term);
+    return node ? node->postings.view() : PostingView();
+}
+
+void MemoryIndexReader::forEachTerm(const TermVisitor& visitor) const
+{
+    // 跳表按关键词升序排列
+    for (const InvertedIndexNode& node : *index) {
+        visitor(node.keyword, node.postings.view());
+    }
+}
+
+void MemoryIndexReader::forEachTermWithPrefix(const QString& prefix, const TermVisitor& visitor) const
+{
+    for (auto it = index->lowerBound(prefix); it != index->end(); ++it) {
+        const InvertedIndexNode& node = *it;
+        if (!node.keyword.startsWith(prefix)) {
+            break;
+        }
+        visitor(node.keyword, node.postings.view());
+    }
+}
+
+QString MemoryIndexReader::ceilingTerm(const QString& term) const
+{
+    auto it = index->lowerBound(term);
+    return it != index->end() ? (*it).keyword : QString();
+}
@@ -0,0 +1,82 @@
+#ifndef INDEXREADER_H
+#define INDEXREADER_H
+
+#include <QBitArray>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "indexbuilder.h"
+#include "levenshteinautomaton.h"
+#include "postinglist.h"
+#include "skiplist.h"
+#include "tokenoffsettable.h"
+
+// 只读索引：查询只通过这个接口访问索引，
+// 实现可以是内存中的跳表，也可以是映射到内存的段文件
+class IndexReader {
+public:
+    // 遍历词典的回调：词、倒排表
+    typedef std::function<void(const QString&, const PostingView&)> TermVisitor;
+    // 模糊匹配的回调：词、与查询词的编辑距离、倒排表
+    typedef std::function<void(const QString&, int, const PostingView&)> FuzzyVisitor;
+
+    virtual ~IndexReader() {}
+
+    virtual int documentCount() const = 0;
+    virtual int documentLength(int docId) const = 0;               // 文档的词数
+    virtual QString documentPath(int docId) const = 0;
+    virtual TokenOffsetView tokenOffsets(int docId) const = 0;     // 文档的词位置表
+
+    virtual PostingView postings(const QString& term) const = 0;  // 词不存在时返回空表
+    virtual int termCount() const = 0;
+    virtual void forEachTerm(const TermVisitor& visitor) const = 0; // 按词升序遍历
+    virtual void forEachTermWithPrefix(const QString& prefix, const TermVisitor& visitor) const = 0;
+    virtual QString ceilingTerm(const QString& term) const = 0;    // 第一个不小于term的词，没有时返回空字符串
+
+    // 与Levenshtein自动机求交，按词升序遍历被接受的词：沿词典中存在的前缀深度优先前进，
+    // 自动机不可能再接受的前缀用ceilingTerm整段跳过，不逐个检查词典中的词
+    void forEachFuzzyTerm(const LevenshteinAutomaton& automaton, const FuzzyVisitor& visitor) const;
+
+    // 遍历与通配符模式匹配的词（不保证顺序）。默认在前缀范围内（模式以*开头时为整个词典）逐个检查，
+    // 有k-gram索引的实现先用k-gram找出候选词
+    virtual void forEachWildcardTerm(const QString& pattern, const TermVisitor& visitor) const;
+
+    TokenSpan tokenSpan(int docId, int first, int count = 1) const
+    {
+        return tokenOffsets(docId).span(first, count);
+    }
+};
+
+// 查询时的一个段：段内docId加上docBase为全局docId，deleted中置位的文档已被删除
+struct SearchSegment {
+    const IndexReader* reader = nullptr;
+    int docBase = 0;
+    QBitArray deleted;       // 为空表示段内没有删除的文档
+
+    bool isDeleted(int docId) const { return docId < deleted.size() && deleted.testBit(docId); }
+};
+
+// 内存中的索引：建立索引后直接在跳表和文档统计信息上查询
+class MemoryIndexReader : public IndexReader {
+public:
+    MemoryIndexReader(const SkipList* index, const QVector<DocumentStats>* documentStats,
+                      const QVector<QString>* documentPaths);
+
+    int documentCount() const override { return documentStats->size(); }
+    int documentLength(int docId) const override { return (*documentStats)[docId].tokenCount; }
+    QString documentPath(int docId) const override;
+    TokenOffsetView tokenOffsets(int docId) const override { return (*documentStats)[docId].tokenOffsets.view(); }
+
+    PostingView postings(const QString& term) const override;
+    int termCount() const override { return index->size(); }
+    void forEachTerm(const TermVisitor& visitor) const override;
+    void forEachTermWithPrefix(const QString& prefix, const TermVisitor& visitor) const override;
+    QString ceilingTerm(const QString& term) const override;
+
+private:
+    const SkipList* index;
+    const QVector<DocumentStats>* documentStats;
+    const QVector<QString>* documentPaths;
+};
+
+#endif // INDEXREADER_H
@@ -0,0 +1,158 @@
+#include "ingestpipeline.h"
+#include "documentreader.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrent>
+#include <atomic>
+
+namespace {
+    // 读取阶段交给建表阶段的批次：未解码的文件内容
+    struct RawBatch {
+        int firstDocId = 0;
+        QVector<QByteArray> documents;
+        qint64 bytes = 0;
+    };
+
+    // 按字节数限制容量的阻塞队列。队列为空时总能放入一个批次，单个批次超过容量也不会死锁；
+    // close之后pop取完剩下的批次返回false
+    class BatchQueue {
+    public:
+        explicit BatchQueue(qint64 capacity) : capacity(capacity), used(0), closed(false) {}
+
+        void push(const RawBatch& batch)
+        {
+            QMutexLocker locker(&mutex);
+            while (!items.isEmpty() && used + batch.bytes > capacity) {
+                notFull.wait(&mutex);
+            }
+            items.enqueue(batch);
+            used += batch.bytes;
+            notEmpty.wakeOne();
+        }
+
+        bool pop(RawBatch& batch)
+        {
+            QMutexLocker locker(&mutex);
+            while (items.isEmpty() && !closed) {
+                notEmpty.wait(&mutex);
+            }
+            if (items.isEmpty()) {
+                return false;
+            }
+            batch = items.dequeue();
+            used -= batch.bytes;
+            notFull.wakeAll();
+            return true;
+        }
+
+        void close()
+        {
+            QMutexLocker locker(&mutex);
+            closed = true;
+            notEmpty.wakeAll();
+        }
+
+    private:
+        QMutex mutex;
+        QWaitCondition notFull;
+        QWaitCondition notEmpty;
+        QQueue<RawBatch> items;
+        qint64 capacity;
+        qint64 used;
+        bool closed;
+    };
+}
+
+QList<QStringList> IngestPipeline::split(const QStringList& paths, const QHash<QString, FileState>& states,
+                                         qint64 partBytes, int partFiles)
+{
+    QList<QStringList> parts;
+    qint64 bytes = 0;
+    for (const QString& path : paths) {
+        qint64 size = states.value(path).size;
+        if (parts.isEmpty() || (bytes > 0 && bytes + size > partBytes) || parts.last().size() >= partFiles) {
+            parts.append(QStringList());
+            bytes = 0;
+        }
+        parts.last().append(path);
+        bytes += size;
+    }
+    return parts;
+}
+
+IngestResult IngestPipeline::run(const QStringList& paths, TermDictionary& dictionary,
+                                 const IndexBuilder::ProgressCallback& progress, int queueBytes, int threads)
+{
+    IngestResult result;
+    BatchQueue queue(queueBytes);
+    QMutex resultMutex;
+    std::atomic<int> processed(0);
+    const int total = paths.size();
+
+    // 读取线程和工作线程会互相等待，使用单独的线程池，不占用全局线程池
+    const int workers = threads > 0 ? threads : qMax(1, QThread::idealThreadCount());
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers + 1);
+
+    // 读取：只有这个线程写result.paths，无法读取的文件跳过，docId保持连续
+    QFuture<void> reader = QtConcurrent::run(&pool, [&]() {
+        RawBatch batch;
+        for (const QString& path : paths) {
+            QByteArray data;
+            if (!DocumentReader::readBytes(path, data)) {
+                continue;
+            }
+            batch.bytes += data.size();
+            batch.documents.append(data);
+            result.paths.append(path);
+            if (batch.documents.size() == IndexBuilder::BATCH_SIZE) {
+                queue.push(batch);
+                batch = RawBatch();
+                batch.firstDocId = result.paths.size();
+            }
+        }
+        if (!batch.documents.isEmpty()) {
+            queue.push(batch);
+        }
+        queue.close();
+    });
+
+    // 解码、分词建表：批次的原文在倒排表加入词典后随contents一起释放
+    auto worker = [&]() {
+        RawBatch raw;
+        while (queue.pop(raw)) {
+            const int firstDocId = raw.firstDocId;
+            QVector<QString> contents;
+            contents.reserve(raw.documents.size());
+            for (QByteArray& data : raw.documents) {
+                contents.append(DocumentReader::decode(data));
+                data.clear();
+            }
+            raw = RawBatch();
+
+            IndexBatch batch = IndexBuilder::processBatch(contents, firstDocId, dictionary);
+            int done = processed += contents.size();
+            {
+                QMutexLocker locker(&resultMutex);
+                result.batches.append(batch);
+            }
+            if (progress) {
+                progress(done, total, QString("正在构建索引... (%1/%2)").arg(done).arg(total));
+            }
+        }
+    };
+    QVector<QFuture<void>> futures;
+    for (int i = 0; i < workers; ++i) {
+        futures.append(QtConcurrent::run(&pool, worker));
+    }
+
+    reader.waitForFinished();
+    for (QFuture<void>& future : futures) {
+        future.waitForFinished();
+    }
+    return result;
+}
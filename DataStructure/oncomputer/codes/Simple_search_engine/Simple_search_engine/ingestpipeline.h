@@ -0,0 +1,42 @@
+#ifndef INGESTPIPELINE_H
+#define INGESTPIPELINE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <climits>
+#include "incrementalindex.h"
+#include "indexbuilder.h"
+#include "termdictionary.h"
+
+// 一次流式导入的结果：倒排表已经加入词典，批次中只有文档统计信息
+struct IngestResult {
+    QList<IndexBatch> batches;
+    QVector<QString> paths;      // docId为i的文档的路径，无法读取的文件不占docId
+};
+
+// 流式导入：读取和建表两个阶段由按字节数限制容量的队列连接。
+//   读取线程按顺序读文件，每BATCH_SIZE个文档组成一个批次放入队列，队列满时等待（背压）；
+//   各工作线程从队列取出批次，解码、分词并把倒排表加入词典，之后立即释放批次的原文。
+// 同时在内存中的原文不超过队列容量加上每个工作线程一个批次，显示摘要时再从磁盘读取原文。
+// 倒排表在提交前一直留在内存中，导入很多文件时用split分成若干部分，每部分导入后提交一次
+class IngestPipeline {
+public:
+    static const int DEFAULT_QUEUE_BYTES = 32 * 1024 * 1024;
+    static const qint64 DEFAULT_PART_BYTES = 256LL * 1024 * 1024;
+
+    // 按文件大小把paths分成若干部分，每部分的文件总大小不超过partBytes（单个文件更大时单独一部分），
+    // 文件数不超过partFiles
+    static QList<QStringList> split(const QStringList& paths, const QHash<QString, FileState>& states,
+                                    qint64 partBytes = DEFAULT_PART_BYTES, int partFiles = INT_MAX);
+
+    // 为paths中的文件建立索引，docId从0开始；progress在工作线程中调用。
+    // threads为工作线程数，0表示按CPU核数
+    static IngestResult run(const QStringList& paths, TermDictionary& dictionary,
+                            const IndexBuilder::ProgressCallback& progress = IndexBuilder::ProgressCallback(),
+                            int queueBytes = DEFAULT_QUEUE_BYTES, int threads = 0);
+};
+
+#endif // INGESTPIPELINE_H
@@ -3,35 +3,27 @@
 
 #include <QString>
 #include <QVector>
-#include <QMap>
+#include "postinglist.h"
 
-// 文档节点结构体，用于存储文档ID、在文档中的位置和上下文
+// 搜索结果节点，用于存储命中的文档ID和在文档中的位置
+// 上下文摘要不在这里保存，只在显示结果时按位置生成
 struct DocumentNode {
     int docId;                // 文档ID
     int position;             // 单词在文档中的位置
-    QString context;          // 单词的上下文（前后文）
     double weight;            // 文档权重
+    int length;               // 匹配占用的词数，短语匹配时大于1
 
-    DocumentNode(int id = 0, int pos = 0, const QString& ctx = "", double w = 1.0)
-        : docId(id), position(pos), context(ctx), weight(w) {}
+    DocumentNode(int id = 0, int pos = 0, double w = 1.0, int len = 1)
+        : docId(id), position(pos), weight(w), length(len) {}
 };
 
-// 倒排索引节点，用于存储关键词与包含该关键词的文档列表
+// 倒排索引节点，用于存储关键词与包含该关键词的压缩文档列表
 struct InvertedIndexNode {
     QString keyword;                   // 关键词
-    QVector<DocumentNode> documents;   // 包含此关键词的文档列表
+    PostingList postings;              // 包含此关键词的文档及位置（压缩存储）
     
     InvertedIndexNode(const QString& key = "")
         : keyword(key) {}
 };
 
-// 词典树节点，用于快速检索关键词
-struct TrieNode {
-    QMap<QChar, TrieNode*> children;   // 子节点
-    bool isEndOfWord;                  // 是否是单词结尾
-    int indexId;                       // 对应的倒排索引ID，-1表示不是单词结尾
-
-    TrieNode() : isEndOfWord(false), indexId(-1) {}
-};
-
 #endif // INVERTEDINDEXNODE_H 
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "kgramindex.h"
+#include "postinglist.h"
+#include <algorithm>
+
+namespace {
+    inline bool isWildcardChar(ushort ch)
+    {
+        return ch == '*' || ch == '?';
+    }
+
+    // text中的k-gram，升序且没有重复，跨越通配符的k-gram不计入；result被覆盖
+    void collectGrams(const QString& text, QVector<quint32>& result)
+    {
+        result.clear();
+        ushort previous = KGramIndex::BOUNDARY;
+        for (int i = 0; i <= text.length(); ++i) {
+            ushort current = i < text.length() ? text.at(i).unicode() : KGramIndex::BOUNDARY;
+            if (!isWildcardChar(previous) && !isWildcardChar(current)) {
+                result.append((quint32(previous) << 16) | current);
+            }
+            previous = current;
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+
+    // 按高32位（k-gram）稳定排序：两趟16位的基数排序，词序号加入时已经升序，排序后仍然升序
+    void sortByGram(QVector<quint64>& entries)
+    {
+        QVector<quint64> buffer(entries.size());
+        for (int shift = 32; shift < 64; shift += 16) {
+            QVector<int> starts(0x10000 + 1, 0);
+            for (quint64 entry : entries) {
+                starts[((entry >> shift) & 0xFFFF) + 1]++;
+            }
+            for (int i = 1; i < starts.size(); ++i) {
+                starts[i] += starts[i - 1];
+            }
+            for (quint64 entry : entries) {
+                buffer[starts[(entry >> shift) & 0xFFFF]++] = entry;
+            }
+            entries.swap(buffer);
+        }
+    }
+
+    // 解码一个词序号列表
+    void decodeList(const uchar* p, const uchar* end, QVector<int>& result)
+    {
+        int ordinal = 0;
+        while (p < end) {
+            ordinal += static_cast<int>(VarInt::decode(p));
+            result.append(ordinal);
+        }
+    }
+
+    // 保留result中也在members里的序号，两边都是升序
+    void intersect(const QVector<int>& members, QVector<int>& result)
+    {
+        int kept = 0;
+        int j = 0;
+        for (int i = 0; i < result.size() && j < members.size(); ++i) {
+            while (j < members.size() && members[j] < result[i]) {
+                ++j;
+            }
+            if (j < members.size() && members[j] == result[i]) {
+                result[kept++] = result[i];
+            }
+        }
+        result.resize(kept);
+    }
+}
+
+qint64 KGramIndexView::byteCount() const
+{
+    if (isEmpty()) {
+        return 0;
+    }
+    return qint64(gramCount) * sizeof(quint32) + qint64(gramCount + 1) * sizeof(quint32) + offsets[gramCount];
+}
+
+bool KGramIndexView::candidates(const QString& pattern, QVector<int>& result) const
+{
+    result.clear();
+
+    // 每个约束是一段连续的k-gram，其中各列表的并集：完整的k-gram只有一项；
+    // 两边都是通配符的单个字符c对应所有以c开头的k-gram（包括c与结尾边界符），即含有c的词
+    struct Constraint {
+        int first;
+        int last;
+        quint32 bytes;
+        bool operator<(const Constraint& other) const { return bytes < other.bytes; }
+    };
+    QVector<Constraint> constraints;
+    auto addRange = [&](quint32 low, quint32 high) {
+        Constraint constraint;
+        constraint.first = static_cast<int>(std::lower_bound(grams, grams + gramCount, low) - grams);
+        constraint.last = static_cast<int>(std::lower_bound(grams, grams + gramCount, high) - grams);
+        constraint.bytes = offsets[constraint.last] - offsets[constraint.first];
+        constraints.append(constraint);
+    };
+    for (quint32 gram : KGramIndex::gramsOf(pattern)) {
+        addRange(gram, gram + 1);
+    }
+    for (int i = 0; i < pattern.length(); ++i) {
+        if (isWildcardChar(pattern.at(i).unicode())) {
+            continue;
+        }
+        bool alone = i > 0 && isWildcardChar(pattern.at(i - 1).unicode())
+                     && i + 1 < pattern.length() && isWildcardChar(pattern.at(i + 1).unicode());
+        if (alone) {
+            quint32 ch = pattern.at(i).unicode();
+            addRange(ch << 16, (ch + 1) << 16);
+        }
+    }
+    if (constraints.isEmpty()) {
+        return false;
+    }
+
+    // 有一个约束没有词就没有候选词；字节数少的先求交
+    std::sort(constraints.begin(), constraints.end());
+    for (int k = 0; k < constraints.size(); ++k) {
+        const Constraint& constraint = constraints[k];
+        if (constraint.bytes == 0) {
+            result.clear();
+            return true;
+        }
+        // 候选已经很少时，不值得再解码很长的列表，留给模式确认
+        if (k > 0 && constraint.bytes > quint32(result.size()) * 16) {
+            break;
+        }
+        QVector<int> members;
+        for (int index = constraint.first; index < constraint.last; ++index) {
+            decodeList(data + offsets[index], data + offsets[index + 1], members);
+        }
+        if (constraint.last - constraint.first > 1) {
+            std::sort(members.begin(), members.end());
+            members.erase(std::unique(members.begin(), members.end()), members.end());
+        }
+        if (k == 0) {
+            result = members;
+        } else {
+            intersect(members, result);
+        }
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+    return true;
+}
+
+void KGramIndex::build(const QVector<QString>& terms)
+{
+    clear();
+
+    // 按k-gram排序后，同一个k-gram的词序号连续且升序
+    QVector<quint64> entries;
+    QVector<quint32> termGrams;
+    for (int ordinal = 0; ordinal < terms.size(); ++ordinal) {
+        collectGrams(terms[ordinal], termGrams);
+        for (quint32 gram : termGrams) {
+            entries.append((quint64(gram) << 32) | quint32(ordinal));
+        }
+    }
+    sortByGram(entries);
+
+    int previous = 0;
+    for (int i = 0; i < entries.size(); ++i) {
+        quint32 gram = quint32(entries[i] >> 32);
+        int ordinal = int(quint32(entries[i]));
+        if (grams.isEmpty() || grams.last() != gram) {
+            grams.append(gram);
+            offsets.append(data.size());
+            previous = 0;
+        }
+        VarInt::encode(data, quint32(ordinal - previous));
+        previous = ordinal;
+    }
+    offsets.append(data.size());
+}
+
+void KGramIndex::clear()
+{
+    grams.clear();
+    offsets.clear();
+    data.clear();
+}
+
+KGramIndexView KGramIndex::view() const
+{
+    KGramIndexView view;
+    if (!grams.isEmpty()) {
+        view.grams = grams.constData();
+        view.offsets = offsets.constData();
+        view.data = reinterpret_cast<const uchar*>(data.constData());
+        view.gramCount = grams.size();
+    }
+    return view;
+}
+
+QVector<quint32> KGramIndex::gramsOf(const QString& text)
+{
+    QVector<quint32> result;
+    collectGrams(text, result);
+    return result;
+}
@@ -0,0 +1,51 @@
+#ifndef KGRAMINDEX_H
+#define KGRAMINDEX_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// 只读的k-gram索引，可以直接指向段文件中映射的数据
+//   grams：    gramCount个k-gram，升序
+//   offsets：  gramCount + 1项，第i个k-gram的词序号列表在data中的字节区间
+//   data：     各列表为升序的词序号，存与前一个的差（第一个与0的差），varint编码
+struct KGramIndexView {
+    const quint32* grams = nullptr;
+    const quint32* offsets = nullptr;
+    const uchar* data = nullptr;
+    int gramCount = 0;
+
+    bool isEmpty() const { return gramCount == 0; }
+    qint64 byteCount() const;
+
+    // 含有pattern中全部k-gram（两边都是通配符的单个字符只要求词中含有这个字符）的词的序号，升序；
+    // 结果只是候选，还要用Wildcard::matches确认。pattern中没有字符时返回false，需要检查所有的词
+    bool candidates(const QString& pattern, QVector<int>& result) const;
+};
+
+// 词典的k-gram（k = 2）索引，用于通配符查询。
+//   词的首尾各加一个边界符，"tion" 的k-gram为 ^t ti io on n^；
+//   模式按通配符分开，只取不跨越通配符的k-gram，"*tion" 得到 ti io on n^，
+//   各k-gram的词序号列表求交就是候选词，再逐个用模式确认。
+//   k-gram按首字符排列，以同一个字符开头的k-gram连续存放，"*a*" 取这一段列表的并集
+class KGramIndex {
+public:
+    static const ushort BOUNDARY = 0;
+
+    // terms按词典顺序排列，terms[i]的序号为i
+    void build(const QVector<QString>& terms);
+    void clear();
+
+    KGramIndexView view() const;
+
+    // text（词或模式）中的k-gram，升序且没有重复，跨越通配符的k-gram不计入
+    static QVector<quint32> gramsOf(const QString& text);
+
+private:
+    QVector<quint32> grams;
+    QVector<quint32> offsets;
+    QByteArray data;
+};
+
+#endif // KGRAMINDEX_H
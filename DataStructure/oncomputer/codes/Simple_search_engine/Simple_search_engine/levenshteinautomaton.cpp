@@ -0,0 +1,43 @@
+#include "levenshteinautomaton.h"
+#include <algorithm>
+
+LevenshteinAutomaton::LevenshteinAutomaton(const QString& term, int maxEdits)
+    : pattern(term), edits(qBound(0, maxEdits, MAX_EDITS))
+{
+    for (const QChar& ch : pattern) {
+        alphabet.append(ch.unicode());
+    }
+    std::sort(alphabet.begin(), alphabet.end());
+    alphabet.erase(std::unique(alphabet.begin(), alphabet.end()), alphabet.end());
+}
+
+int LevenshteinAutomaton::editsForLength(int length)
+{
+    if (length <= 2) {
+        return 0;
+    }
+    return length <= 5 ? 1 : MAX_EDITS;
+}
+
+void LevenshteinAutomaton::start(int* row) const
+{
+    for (int i = 0; i <= pattern.length(); ++i) {
+        row[i] = qMin(i, edits + 1);
+    }
+}
+
+int LevenshteinAutomaton::advance(const int* row, int ch, int* next) const
+{
+    const ushort* chars = pattern.utf16();
+    const int limit = edits + 1;
+    next[0] = qMin(row[0] + 1, limit);
+    int smallest = next[0];
+    for (int i = 1; i <= pattern.length(); ++i) {
+        int cost = row[i - 1] + (chars[i - 1] == ch ? 0 : 1);   // 匹配或替换
+        cost = qMin(cost, row[i] + 1);                          // 读入的字符多余
+        cost = qMin(cost, next[i - 1] + 1);                     // 缺少查询词中的字符
+        next[i] = qMin(cost, limit);
+        smallest = qMin(smallest, next[i]);
+    }
+    return smallest;
+}
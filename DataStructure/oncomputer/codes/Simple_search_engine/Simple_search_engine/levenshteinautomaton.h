@@ -0,0 +1,45 @@
+#ifndef LEVENSHTEINAUTOMATON_H
+#define LEVENSHTEINAUTOMATON_H
+
+#include <QString>
+#include <QVector>
+
+// Levenshtein自动机：接受与查询词的编辑距离（插入、删除、替换各算一次）不超过maxEdits的词。
+// 状态是编辑距离矩阵的一行：row[i]为已读入的字符串与查询词前i个字符的编辑距离，
+// 超过maxEdits的值都记为maxEdits + 1，状态数有限；
+// 一行中的最小值超过maxEdits时，再读入任何字符都不可能被接受
+class LevenshteinAutomaton {
+public:
+    static const int MAX_EDITS = 2;
+
+    LevenshteinAutomaton(const QString& term, int maxEdits);
+
+    // 按词长决定允许的编辑次数：1-2个字符不纠错，3-5个字符1次，更长2次
+    static int editsForLength(int length);
+
+    const QString& term() const { return pattern; }
+    int maxEdits() const { return edits; }
+    int rowSize() const { return pattern.length() + 1; }
+
+    // 查询词中出现的字符，升序且没有重复
+    const QVector<ushort>& characters() const { return alphabet; }
+
+    void start(int* row) const;
+
+    // 读入一个字符，由row求出next，返回next中的最小值
+    int step(const int* row, ushort ch, int* next) const { return advance(row, ch, next); }
+    // 读入一个不在查询词中的字符
+    int stepOther(const int* row, int* next) const { return advance(row, -1, next); }
+
+    bool isMatch(const int* row) const { return row[pattern.length()] <= edits; }
+    int distance(const int* row) const { return row[pattern.length()]; }
+
+private:
+    int advance(const int* row, int ch, int* next) const;
+
+    QString pattern;
+    int edits;
+    QVector<ushort> alphabet;
+};
+
+#endif // LEVENSHTEINAUTOMATON_H
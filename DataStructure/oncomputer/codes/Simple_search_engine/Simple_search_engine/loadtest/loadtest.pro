@@ -0,0 +1,11 @@
+QT = core core5compat concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = search_loadtest
+
+include(../searchcore.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,223 @@
+// 搜索压力测试：把文件夹导入一个临时的增量索引，再用多个线程重放查询日志，
+// 统计建索引用时、索引文件大小、各编码的文件数、查询延迟的p50/p99和每秒查询数，作为各项搜索改动的回归数据。
+// 查询日志每行一个查询（UTF-8），空行和以#开头的行忽略。
+// 不指定查询日志（或指定为-）时，用索引中文档频率最高的词生成一份按Zipf分布偏斜的日志，
+// 模拟少数热门查询占大多数的情况。--no-cache 关闭查询结果缓存；
+// --shards=N 把索引分成N个段并总是并行查询各段，用于在小文件夹上比较scatter-gather与依次查询
+//
+// 用法: search_loadtest <文件夹> [查询日志|-] [线程数] [重复次数] [--no-cache] [--shards=N]
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include "documentreader.h"
+#include "incrementalindex.h"
+#include "queryengine.h"
+
+static const int POPULAR_QUERIES = 300;    // 生成的日志中不同查询的个数
+static const int GENERATED_LOG_SIZE = 20000;
+
+static QStringList loadQueryLog(const QString& path)
+{
+    QStringList queries;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return queries;
+    }
+    for (const QByteArray& line : file.readAll().split('\n')) {
+        QString query = QString::fromUtf8(line).trimmed();
+        if (!query.isEmpty() && !query.startsWith('#')) {
+            queries.append(query);
+        }
+    }
+    return queries;
+}
+
+// 取文档频率最高的词，前一半作为单词查询，后一半两两组成双词查询；
+// 第i个查询被选中的概率与 1/(i+1) 成正比
+static QStringList generateQueryLog(const QVector<SearchSegment>& segments)
+{
+    QHash<QString, int> frequencies;
+    for (const SearchSegment& segment : segments) {
+        segment.reader->forEachTerm([&frequencies](const QString& term, const PostingView& postings) {
+            frequencies[term] += postings.documentFrequency;
+        });
+    }
+    QVector<QPair<int, QString>> terms;
+    terms.reserve(frequencies.size());
+    for (auto it = frequencies.constBegin(); it != frequencies.constEnd(); ++it) {
+        terms.append(qMakePair(-it.value(), it.key()));
+    }
+    int count = qMin(POPULAR_QUERIES, static_cast<int>(terms.size()));
+    std::partial_sort(terms.begin(), terms.begin() + count, terms.end());
+
+    QStringList distinct;
+    for (int i = 0; i < count; ++i) {
+        if (i < count / 2 || i + 1 >= count) {
+            distinct.append(terms[i].second);
+        } else {
+            distinct.append(terms[i].second + " " + terms[i + 1].second);
+        }
+    }
+
+    std::vector<double> weights;
+    for (int i = 0; i < distinct.size(); ++i) {
+        weights.push_back(1.0 / (i + 1));
+    }
+    std::mt19937 random(1);
+    std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+    QStringList queries;
+    for (int i = 0; i < GENERATED_LOG_SIZE && !distinct.isEmpty(); ++i) {
+        queries.append(distinct[zipf(random)]);
+    }
+    return queries;
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QStringList args = QCoreApplication::arguments();
+    bool useCache = !args.contains("--no-cache");
+    args.removeAll("--no-cache");
+    int shards = 0;
+    for (int i = args.size() - 1; i > 0; --i) {
+        if (args.at(i).startsWith("--shards=")) {
+            shards = qMax(1, args.takeAt(i).mid(9).toInt());
+        }
+    }
+    if (args.size() < 2) {
+        out << "用法: search_loadtest <文件夹> [查询日志|-] [线程数] [重复次数] [--no-cache] [--shards=N]" << Qt::endl;
+        return 1;
+    }
+    QString folderPath = args.at(1);
+    QString logPath = args.size() > 2 ? args.at(2) : QString("-");
+    int threads = args.size() > 3 ? qMax(1, args.at(3).toInt()) : QThread::idealThreadCount();
+    int rounds = args.size() > 4 ? qMax(1, args.at(4).toInt()) : 1;
+
+    // 导入到临时目录中的新索引，与界面程序的导入过程相同
+    QString indexPath = QDir::temp().filePath("search_loadtest_index");
+    QDir(indexPath).removeRecursively();
+    IncrementalIndex index;
+    QString error;
+    if (!index.open(indexPath, &error)) {
+        out << error << Qt::endl;
+        return 1;
+    }
+    if (shards > 0) {
+        index.setShardCount(shards, 1);
+    }
+    QElapsedTimer timer;
+    timer.start();
+    if (!index.importFolder(folderPath, &error)) {
+        out << error << Qt::endl;
+        return 1;
+    }
+    qint64 indexMs = timer.elapsed();
+    if (index.liveDocumentCount() == 0) {
+        out << "文件夹中没有找到文本文件: " << folderPath << Qt::endl;
+        return 1;
+    }
+    out << QString("导入 %1 个文档: %2 ms, %3 文档/秒, 索引文件 %4 KB, %5 个段")
+               .arg(index.liveDocumentCount())
+               .arg(indexMs)
+               .arg(index.liveDocumentCount() / qMax(indexMs / 1000.0, 0.001), 0, 'f', 0)
+               .arg(index.fileSize() / 1024)
+               .arg(index.segmentCount()) << Qt::endl;
+    QVector<qint64> encodings = DocumentReader::encodingCounts();
+    QStringList encodingStats;
+    for (int i = 0; i < DocumentReader::EncodingCount; ++i) {
+        encodingStats.append(QString("%1 %2").arg(DocumentReader::encodingName(DocumentReader::Encoding(i)))
+                                 .arg(encodings[i]));
+    }
+    out << "文件编码: " << encodingStats.join(", ") << Qt::endl;
+
+    QueryEngine engine;
+    engine.setSegments(index.searchSegments());
+    if (!useCache) {
+        engine.setCacheCapacity(0);
+    }
+    if (shards > 0) {
+        engine.setParallelThreshold(0);
+    }
+
+    QStringList queries = logPath == "-" ? generateQueryLog(engine.segments()) : loadQueryLog(logPath);
+    if (queries.isEmpty()) {
+        out << "查询日志为空: " << logPath << Qt::endl;
+        return 1;
+    }
+
+    // 各线程从共享的计数器领取下一个查询，延迟按查询的序号记录
+    const int total = queries.size() * rounds;
+    QVector<qint64> latencies(total);
+    std::atomic<int> next(0);
+    std::atomic<qint64> results(0);
+    auto worker = [&]() {
+        QElapsedTimer queryTimer;
+        int i;
+        while ((i = next++) < total) {
+            queryTimer.start();
+            int count = engine.search(queries[i % queries.size()]).size();
+            latencies[i] = queryTimer.nsecsElapsed();
+            results += count;
+        }
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    timer.start();
+    QVector<QFuture<void>> futures;
+    for (int t = 0; t < threads; ++t) {
+        futures.append(QtConcurrent::run(&pool, worker));
+    }
+    for (QFuture<void>& future : futures) {
+        future.waitForFinished();
+    }
+    qint64 elapsedNs = timer.nsecsElapsed();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        int i = qMin(static_cast<int>(latencies.size() * p), static_cast<int>(latencies.size()) - 1);
+        return latencies[i] / 1000.0;
+    };
+    out << QString("查询: %1 条 (%2 条不同), %3 个线程, 用时 %4 ms, %5 查询/秒")
+               .arg(total)
+               .arg(QSet<QString>(queries.begin(), queries.end()).size())
+               .arg(threads)
+               .arg(elapsedNs / 1e6, 0, 'f', 1)
+               .arg(total / (elapsedNs / 1e9), 0, 'f', 0) << Qt::endl;
+    out << QString("延迟: p50 %1 us, p99 %2 us, 最大 %3 us, 平均每条 %4 个结果")
+               .arg(percentile(0.50), 0, 'f', 1)
+               .arg(percentile(0.99), 0, 'f', 1)
+               .arg(latencies.last() / 1000.0, 0, 'f', 1)
+               .arg(static_cast<double>(results.load()) / total, 0, 'f', 1) << Qt::endl;
+    const ResultCache& cache = engine.resultCache();
+    out << QString("结果缓存: %1, 命中 %2, 未命中 %3, 占用 %4 KB")
+               .arg(useCache ? "开启" : "关闭")
+               .arg(cache.hits())
+               .arg(cache.misses())
+               .arg(cache.memoryUsage() / 1024) << Qt::endl;
+    QueryEngine::WildcardStats wildcards = engine.wildcardStats();
+    if (wildcards.patterns > 0) {
+        out << QString("通配符: 扩展 %1 次, 平均匹配 %2 个词, %3 次超过上限 %4")
+                   .arg(wildcards.patterns)
+                   .arg(static_cast<double>(wildcards.matchedTerms) / wildcards.patterns, 0, 'f', 1)
+                   .arg(wildcards.truncatedPatterns)
+                   .arg(QueryEngine::MAX_WILDCARD_EXPANSIONS) << Qt::endl;
+    }
+
+    index.close();
+    QDir(indexPath).removeRecursively();
+    return 0;
+}
@@ -4,7 +4,6 @@
 #include <QDateTime>
 #include <QtMath>
 #include <algorithm>
-#include <QtCore5Compat/QTextCodec>
 #include <QtConcurrent>
 #include <QIcon>
 #include <QFont>
@@ -13,21 +12,21 @@
 #include <QScrollArea>
 #include <QStyleOption>
 #include <QPainter>
-#include <functional>
 #include <QAtomicInt>
+#include <QStandardPaths>
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), root(new TrieNode())
+    : QMainWindow(parent), ingestedFiles(0), importedDocuments(0), contentCache(CONTENT_CACHE_SIZE)
 {
     setWindowTitle("智能文档搜索系统");
     resize(1200, 800);
     setMinimumSize(900, 600);
     
     // 初始化异步处理组件
-    fileLoadWatcher = new QFutureWatcher<QPair<QVector<QString>, QVector<QString>>>();
-    indexWatcher = new QFutureWatcher<IndexBatch>();
-    connect(fileLoadWatcher, &QFutureWatcher<QPair<QVector<QString>, QVector<QString>>>::finished, this, &MainWindow::handleFilesLoaded);
-    connect(indexWatcher, &QFutureWatcher<IndexBatch>::finished, this, &MainWindow::handleIndexingFinished);
+    ingestWatcher = new QFutureWatcher<IngestResult>();
+    mergeWatcher = new QFutureWatcher<MergeResult>();
+    connect(ingestWatcher, &QFutureWatcher<IngestResult>::finished, this, &MainWindow::handleIndexingFinished);
+    connect(mergeWatcher, &QFutureWatcher<MergeResult>::finished, this, &MainWindow::handleMergeFinished);
     connect(this, &MainWindow::progressUpdated, this, &MainWindow::updateProgressUI, Qt::QueuedConnection);
     
     createUI();
@@ -37,24 +36,26 @@ MainWindow::MainWindow(QWidget *parent)
     connect(searchButton, &QPushButton::clicked, this, &MainWindow::performSearch);
     connect(clearButton, &QPushButton::clicked, this, &MainWindow::clearSearch);
     connect(resultsList, &QListWidget::itemClicked, this, &MainWindow::displayFileContent);
+    
+    // 有上次保存的索引时直接映射，不需要重新导入
+    openIndex();
 }
 
 MainWindow::~MainWindow()
 {
-    // 如果有正在运行的异步任务，先取消它们
-    if (fileLoadWatcher && fileLoadWatcher->isRunning()) {
-        fileLoadWatcher->cancel();
-        fileLoadWatcher->waitForFinished();
+    // 正在建立索引的部分不能取消，等它结束；没有提交的部分下次导入时重新建立
+    if (ingestWatcher && ingestWatcher->isRunning()) {
+        ingestWatcher->waitForFinished();
     }
-    if (indexWatcher && indexWatcher->isRunning()) {
-        indexWatcher->cancel();
-        indexWatcher->waitForFinished();
+    // 合并不能取消，等它写完；没有安装的新段在下次打开索引时清理
+    if (mergeWatcher && mergeWatcher->isRunning()) {
+        mergeWatcher->waitForFinished();
     }
     
     // 清理资源
     clearIndex();
-    delete fileLoadWatcher;
-    delete indexWatcher;
+    delete ingestWatcher;
+    delete mergeWatcher;
 }
 
 void MainWindow::updateProgressUI(int value, int maximum, const QString& message)
@@ -117,6 +118,14 @@ void MainWindow::createUI()
     QFont searchFont("Microsoft YaHei", 10);
     searchBox->setFont(searchFont);
     
+    // 输入时按最后一个词的前缀从索引中查找候选词，常用的词排在前面
+    completionModel = new QStringListModel(this);
+    completer = new QCompleter(this);
+    completer->setModel(completionModel);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setMaxVisibleItems(QueryEngine::DEFAULT_COMPLETIONS);
+    searchBox->setCompleter(completer);
+    
     searchButton = new QPushButton("搜索");
     searchButton->setIcon(style()->standardIcon(QStyle::SP_FileDialogContentsView));
     searchButton->setMinimumHeight(40);
@@ -204,10 +213,39 @@ void MainWindow::createUI()
     
     // 连接回车键搜索
     connect(searchBox, &QLineEdit::returnPressed, this, &MainWindow::performSearch);
+    connect(searchBox, &QLineEdit::textEdited, this, &MainWindow::updateCompletions);
+}
+
+void MainWindow::updateCompletions(const QString& text)
+{
+    // 只补全最后一个词（跳过引号和括号），候选项带上前面已输入的部分，选中后替换整个搜索框
+    int start = text.length();
+    while (start > 0 && !text.at(start - 1).isSpace()
+           && text.at(start - 1) != '"' && text.at(start - 1) != '(') {
+        --start;
+    }
+    QString prefix = text.mid(start);
+    
+    QStringList completions;
+    if (!prefix.isEmpty()) {
+        QString head = text.left(start);
+        for (const QString& term : queryEngine.complete(prefix)) {
+            completions.append(head + term);
+        }
+    }
+    completionModel->setStringList(completions);
+    if (!completions.isEmpty()) {
+        completer->complete();
+    }
 }
 
 void MainWindow::importFiles()
 {
+    // 上一次导入还在进行时不能开始新的导入
+    if (ingestWatcher->isRunning() || !pendingParts.isEmpty()) {
+        return;
+    }
+    
     // 打开文件夹选择对话框让用户选择要导入的文件夹
     QString folderPath = QFileDialog::getExistingDirectory(this, "选择包含文本文件的文件夹");
     if (folderPath.isEmpty()) {
@@ -229,385 +267,96 @@ void MainWindow::importFiles()
         return;
     }
     
-    // 清除之前的数据
-    clearIndex();
+    // 只为新增或修改过的文件建立索引，文件夹中已删除的文件从索引中删除
+    pendingChanges = index.scanFolder(folderPath);
+    documentPaths.clear();
+    if (pendingChanges.isEmpty()) {
+        statusLabel->setText(QString("✓ 文件夹中的文件没有变化，索引中共 %1 个文件").arg(index.liveDocumentCount()));
+        return;
+    }
+    if (pendingChanges.added.isEmpty()) {
+        mergeIndexResults(QList<IndexBatch>());
+        statusLabel->setText(QString("✓ 已从索引中删除 %1 个文件").arg(pendingChanges.removed.size()));
+        return;
+    }
     
     // 显示进度条
     progressBar->setVisible(true);
     progressBar->setRange(0, 100);
     progressBar->setValue(0);
-    statusLabel->setText("正在读取文件...");
+    statusLabel->setText("正在构建索引...");
     
     // 启动计时器
     processTimer.start();
     
-    // 异步加载文件
-    loadFilesAsync(fileNames, directory);
-}
-
-void MainWindow::loadFilesAsync(const QStringList& fileNames, const QDir& directory)
-{
-    // 将文件路径复制到局部变量以便在并行线程中访问
-    QStringList localFileNames = fileNames;
-    QString dirPath = directory.absolutePath();
-    MainWindow* mainWindowPtr = this; // 在lambda中使用
-
-    // 使用QtConcurrent::run启动异步任务
-    QFuture<QPair<QVector<QString>, QVector<QString>>> future = QtConcurrent::run([localFileNames, dirPath, mainWindowPtr]() {
-        // 在lambda内部创建原子计数器，确保它在整个异步操作期间有效
-        QAtomicInt processedCount(0);
-        QVector<QString> paths;
-        QVector<QString> contents;
-        
-        // 预分配存储空间
-        paths.reserve(localFileNames.size());
-        contents.reserve(localFileNames.size());
-        
-        // 处理所有文件
-        for (const QString& fileName : localFileNames) {
-            QString filePath = dirPath + "/" + fileName;
-            
-            // 读取文件内容
-            QFile file(filePath);
-            if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                qDebug() << "无法打开文件:" << filePath;
-                continue;
-            }
-            
-            // 读取内容并处理编码
-            QByteArray data = file.readAll();
-            file.close();
-            
-            QTextCodec *codec = QTextCodec::codecForName("GB18030");
-            QString content;
-            if (codec) {
-                content = codec->toUnicode(data);
-            } else {
-                content = QString::fromUtf8(data);
-            }
-            
-            // 将结果添加到向量中
-            paths.append(filePath);
-            contents.append(content);
-            
-            // 更新进度
-            int current = processedCount.fetchAndAddRelaxed(1) + 1;
-            int total = localFileNames.size();
-            
-            // 使用信号安全地更新UI
-            emit mainWindowPtr->progressUpdated(current, total, QString("正在读取文件... %1/%2").arg(current).arg(total));
-        }
-        
-        return qMakePair(paths, contents);
-    });
-    
-    // 设置监视器
-    fileLoadWatcher->setFuture(future);
-}
-
-void MainWindow::handleFilesLoaded()
-{
-    // 检查任务是否出错
-    if (fileLoadWatcher->isCanceled()) {
-        progressBar->setVisible(false);
-        statusLabel->setText("文件加载已取消");
-        return;
-    }
-    
-    try {
-        // 获取异步任务的结果
-        QPair<QVector<QString>, QVector<QString>> result = fileLoadWatcher->result();
-        
-        // 更新成员变量
-        documentPaths = result.first;
-        documentContents = result.second;
-        
-        // 所有文件加载完成，开始构建索引
-        statusLabel->setText("正在构建索引...");
-        progressBar->setValue(0);
-        
-        // 使用并行方式构建索引
-        buildInvertedIndexParallel();
-    }
-    catch (const std::exception& e) {
-        // 处理可能的异常
-        progressBar->setVisible(false);
-        statusLabel->setText(QString("加载文件时出错: %1").arg(e.what()));
-        QMessageBox::critical(this, "错误", QString("加载文件时出错: %1").arg(e.what()));
-        return;
-    }
+    // 按文件大小和分片的文档数分成若干部分，依次在后台建立索引
+    pendingParts = IngestPipeline::split(pendingChanges.added, pendingChanges.states,
+                                         IngestPipeline::DEFAULT_PART_BYTES,
+                                         index.shardDocuments(pendingChanges.added.size()));
+    ingestedFiles = 0;
+    importedDocuments = 0;
+    startIngest();
 }
 
 QString MainWindow::readFileContent(const QString& filePath)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    QString content;
+    if (!DocumentReader::read(filePath, content)) {
         qDebug() << "无法打开文件:" << filePath;
-        return QString();
-    }
-    
-    // Qt6方式读取文件内容
-    QByteArray data = file.readAll();
-    file.close();
-    
-    // 在Qt6中使用core5compat模块中的QTextCodec处理中文编码
-    QTextCodec *codec = QTextCodec::codecForName("GB18030");
-    if (codec) {
-        return codec->toUnicode(data);
-    } else {
-        // 如果GB18030编码不可用，使用UTF-8编码
-        return QString::fromUtf8(data);
-    }
-}
-
-QStringList MainWindow::tokenize(const QString& content)
-{
-    QStringList tokens;
-    tokens.reserve(content.length() / 2);  // 预分配空间，假设平均每个token长度为2
-    
-    QString token;
-    token.reserve(8);  // 预分配空间
-    
-    QString chineseToken;
-    chineseToken.reserve(8);  // 预分配空间
-    
-    bool lastWasChinese = false;
-    
-    for (int i = 0; i < content.length(); ++i) {
-        const QChar& ch = content.at(i);
-        
-        // 检查是否是中文字符
-        bool isChinese = (ch.unicode() >= 0x4E00 && ch.unicode() <= 0x9FFF);
-        bool isPunctOrSpace = ch.isPunct() || ch.isSpace();
-        
-        if (isChinese) {
-            // 如果有非中文token，先保存
-            if (!token.isEmpty()) {
-                tokens.append(token.toLower());
-                token.clear();
-            }
-            
-            // 如果前面有标点或空格，先保存当前的中文词组
-            if (isPunctOrSpace && !chineseToken.isEmpty()) {
-                tokens.append(chineseToken);
-                // 同时添加单个字符，以支持单字搜索
-                for (const QChar& c : chineseToken) {
-                    tokens.append(QString(c));
-                }
-                chineseToken.clear();
-            }
-            
-            chineseToken.append(ch);
-            lastWasChinese = true;
-        } else if (isPunctOrSpace) {
-            // 如果是标点或空格，保存之前的token
-            if (!token.isEmpty()) {
-                tokens.append(token.toLower());
-                token.clear();
-            }
-            if (!chineseToken.isEmpty()) {
-                tokens.append(chineseToken);
-                // 同时添加单个字符，以支持单字搜索
-                for (const QChar& c : chineseToken) {
-                    tokens.append(QString(c));
-                }
-                chineseToken.clear();
-            }
-            lastWasChinese = false;
-        } else {
-            // 如果是其他字符（字母或数字）
-            if (lastWasChinese && !chineseToken.isEmpty()) {
-                tokens.append(chineseToken);
-                // 同时添加单个字符，以支持单字搜索
-                for (const QChar& c : chineseToken) {
-                    tokens.append(QString(c));
-                }
-                chineseToken.clear();
-            }
-            
-            if (ch.isLetterOrNumber()) {
-                token.append(ch);
-            }
-            lastWasChinese = false;
-        }
-    }
-    
-    // 处理最后的token
-    if (!token.isEmpty()) {
-        tokens.append(token.toLower());
-    }
-    if (!chineseToken.isEmpty()) {
-        tokens.append(chineseToken);
-        // 同时添加单个字符，以支持单字搜索
-        for (const QChar& c : chineseToken) {
-            tokens.append(QString(c));
-        }
-    }
-    
-    return tokens;
-}
-
-void MainWindow::buildInvertedIndexParallel()
-{
-    // 清除之前的索引
-    invertedIndex.clear();
-    
-    // 设置进度条范围
-    int totalDocuments = documentContents.size();
-    progressBar->setRange(0, totalDocuments);
-    progressBar->setValue(0);
-    
-    // 计算批次大小和数量
-    const int batchSize = 20;  // 减小批次大小，使进度更新更频繁
-    int numBatches = (totalDocuments + batchSize - 1) / batchSize;
-    QList<BatchRange> batches;
-    
-    for (int i = 0; i < numBatches; ++i) {
-        int start = i * batchSize;
-        int end = qMin((i + 1) * batchSize, totalDocuments);
-        batches.append(BatchRange(start, end));
-    }
-    
-    // 创建Future Watcher
-    if (indexWatcher) {
-        delete indexWatcher;
     }
-    indexWatcher = new QFutureWatcher<IndexBatch>();
-    
-    // 连接信号
-    connect(indexWatcher, &QFutureWatcher<IndexBatch>::progressValueChanged,
-            this, [this](int value) {
-                int processedDocs = value * 20;  // 每个批次20个文档
-                processedDocs = qMin(processedDocs, documentContents.size());
-                emit progressUpdated(processedDocs, documentContents.size(),
-                                  QString("正在构建索引... (%1/%2)")
-                                  .arg(processedDocs)
-                                  .arg(documentContents.size()));
-            });
-    
-    connect(indexWatcher, &QFutureWatcher<IndexBatch>::finished,
-            this, &MainWindow::handleIndexingFinished);
-    
-    // 启动并行处理
-    QFuture<IndexBatch> future = QtConcurrent::mapped(batches,
-                                                     [this](const BatchRange& range) {
-                                                         return processBatch(range);
-                                                     });
-    
-    indexWatcher->setFuture(future);
+    return content;
 }
 
-IndexBatch MainWindow::processBatch(const BatchRange& range)
+void MainWindow::startIngest()
 {
-    IndexBatch batch;
-    QMap<QString, QVector<QPair<int, int>>> tempWordPositions;
-    
-    // 计算这个批次中所有文档的总字符数
-    qint64 totalChars = 0;
-    for (int docId = range.start; docId < range.end; ++docId) {
-        totalChars += documentContents[docId].length();
-    }
-    qint64 processedChars = 0;
-    
-    // 处理这个批次中的所有文档
-    for (int docId = range.start; docId < range.end; ++docId) {
-        const QString& content = documentContents[docId];
-        QStringList tokens = tokenize(content);
-        
-        // 记录每个单词在文档中的位置
-        for (int pos = 0; pos < tokens.size(); ++pos) {
-            const QString& token = tokens[pos];
-            tempWordPositions[token].append(qMakePair(docId, pos));
-        }
-        
-        // 更新进度（基于处理的字符数）
-        processedChars += content.length();
-        double progress = static_cast<double>(processedChars) / totalChars;
-        int currentDoc = docId - range.start + 1;
-        int totalDocs = range.end - range.start;
-        emit progressUpdated(
-            docId + 1,
-            documentContents.size(),
-            QString("正在构建索引... 批次进度: %1% (%2/%3)")
-                .arg(qRound(progress * 100))
-                .arg(currentDoc)
-                .arg(totalDocs)
-        );
-    }
-    
-    // 为这个批次构建倒排索引
-    int totalWords = tempWordPositions.size();
-    int processedWords = 0;
-    
-    for (auto it = tempWordPositions.begin(); it != tempWordPositions.end(); ++it) {
-        const QString& word = it.key();
-        const QVector<QPair<int, int>>& positions = it.value();
-        
-        InvertedIndexNode node(word);
-        
-        // 为每个文档位置创建文档节点
-        for (const auto& pos : positions) {
-            int docId = pos.first;
-            int position = pos.second;
-            
-            // 优化上下文提取，减少不必要的分词
-            QString context = extractContext(documentContents[docId], position);
-            
-            // 使用缓存的tokens长度
-            double weight = 1.0 * positions.size() / tokenize(documentContents[docId]).size();
-            
-            node.documents.append(DocumentNode(docId, position, context, weight));
-        }
-        
-        batch.nodes.append(node);
-        batch.keywordMap.insert(word, batch.nodes.size() - 1);
-        
-        // 更新处理进度
-        processedWords++;
-        double progress = static_cast<double>(processedWords) / totalWords;
-        emit progressUpdated(
-            range.end,
-            documentContents.size(),
-            QString("正在构建索引... 处理词条: %1% (%2/%3)")
-                .arg(qRound(progress * 100))
-                .arg(processedWords)
-                .arg(totalWords)
-        );
-    }
-    
-    return batch;
+    // 读取、解码和分词在流水线中进行，原文建立倒排表后即释放，内存中只有这一部分的倒排表
+    QStringList part = pendingParts.takeFirst();
+    const int offset = ingestedFiles;
+    const int total = pendingChanges.added.size();
+    ingestedFiles += part.size();
+    progressBar->setRange(0, total);
+    
+    termDictionary.clear();
+    QFuture<IngestResult> future = QtConcurrent::run([this, part, offset, total]() {
+        return IngestPipeline::run(part, termDictionary, [this, offset, total](int value, int, const QString&) {
+            emit progressUpdated(offset + value, total,
+                                 QString("正在构建索引... (%1/%2)").arg(offset + value).arg(total));
+        });
+    });
+    ingestWatcher->setFuture(future);
 }
 
 void MainWindow::handleIndexingFinished()
 {
-    if (indexWatcher->isCanceled()) {
-        progressBar->setVisible(false);
-        statusLabel->setText("索引构建已取消");
-        return;
-    }
-    
     try {
-        // 获取所有批次的结果
-        QList<IndexBatch> results = indexWatcher->future().results();
-        
-        // 合并结果
-        mergeIndexResults(results);
+        // 这一部分提交为一个段后就可以查询，再开始下一部分
+        IngestResult result = ingestWatcher->result();
+        documentPaths = result.paths;
+        importedDocuments += result.paths.size();
+        mergeIndexResults(result.batches);
+        if (!pendingParts.isEmpty()) {
+            startIngest();
+            return;
+        }
         
         // 计算总用时
         int elapsedMs = processTimer.elapsed();
         
         // 完成
         progressBar->setVisible(false);
-        statusLabel->setText(QString("✓ 已成功导入 %1 个文件并建立索引 (用时: %2 秒)")
-                           .arg(documentPaths.size())
+        statusLabel->setText(QString("✓ 已成功导入 %1 个新增或修改的文件，索引中共 %2 个文件 (用时: %3 秒)")
+                           .arg(importedDocuments)
+                           .arg(index.liveDocumentCount())
                            .arg(elapsedMs / 1000.0, 0, 'f', 2));
         
         QMessageBox::information(this, "导入完成",
-                               QString("✓ 已成功导入 %1 个文件并建立索引\n系统已准备就绪，可以开始搜索\n\n总耗时: %2 秒")
-                               .arg(documentPaths.size())
+                               QString("✓ 已成功导入 %1 个新增或修改的文件\n索引中共 %2 个文件，系统已准备就绪，可以开始搜索\n\n总耗时: %3 秒")
+                               .arg(importedDocuments)
+                               .arg(index.liveDocumentCount())
                                .arg(elapsedMs / 1000.0, 0, 'f', 2));
     }
     catch (const std::exception& e) {
+        pendingParts.clear();
         progressBar->setVisible(false);
         statusLabel->setText(QString("索引构建时出错: %1").arg(e.what()));
         QMessageBox::critical(this, "错误", QString("索引构建时出错: %1").arg(e.what()));
@@ -616,73 +365,58 @@ void MainWindow::handleIndexingFinished()
 
 void MainWindow::mergeIndexResults(const QList<IndexBatch>& results)
 {
-    // 第一遍遍历：收集所有唯一的关键词并插入跳表
-    for (const IndexBatch& batch : results) {
-        for (const InvertedIndexNode& node : batch.nodes) {
-            invertedIndex.insert(node);
-            // 将关键词添加到Trie树中
-            insertToTrie(node.keyword, 0);  // 跳表不需要索引ID
-        }
+    // 已删除的文件标记删除；修改过的文件在加入新内容时替换旧文档
+    index.removeDocuments(pendingChanges.removed);
+    
+    QString error;
+    if (!documentPaths.isEmpty()
+        && !index.addDocuments(results, termDictionary, documentPaths, pendingChanges.states, &error)) {
+        qDebug() << error;
+    }
+    // 提交失败时新文档仍在内存段中可以查询，下次导入时再提交
+    if (!index.commit(&error)) {
+        qDebug() << error;
     }
-}
-
-void MainWindow::insertToTrie(const QString& word, int indexId)
-{
-    TrieNode* current = root;
     
-    for (const QChar& ch : word) {
-        if (!current->children.contains(ch)) {
-            current->children[ch] = new TrieNode();
-        }
-        current = current->children[ch];
+    for (const QString& path : pendingChanges.added + pendingChanges.removed) {
+        contentCache.remove(path);
     }
+    queryEngine.setSegments(index.searchSegments());
     
-    current->isEndOfWord = true;
-    current->indexId = indexId;
+    startMerge();
 }
 
-int MainWindow::searchInTrie(const QString& word)
+void MainWindow::startMerge()
 {
-    TrieNode* current = root;
-    
-    for (const QChar& ch : word) {
-        if (!current->children.contains(ch)) {
-            return -1; // 单词不存在
-        }
-        current = current->children[ch];
+    MergeTask task;
+    if (mergeWatcher->isRunning() || !index.planMerge(task)) {
+        return;
     }
     
-    if (current->isEndOfWord) {
-        return current->indexId;
+    // 合并只读取输入段，查询和下一次导入可以同时进行
+    QFuture<MergeResult> future = QtConcurrent::run([task]() {
+        return IncrementalIndex::runMerge(task);
+    });
+    mergeWatcher->setFuture(future);
+}
+
+void MainWindow::handleMergeFinished()
+{
+    QString error;
+    if (!index.installMerge(mergeWatcher->result(), &error)) {
+        qDebug() << "段合并失败:" << error;
+        return;
     }
     
-    return -1; // 单词不是完整的单词
+    // 结果列表中保存的是文件路径和字符区间，合并改变docId不影响已显示的结果
+    queryEngine.setSegments(index.searchSegments());
+    startMerge();
 }
 
 QVector<DocumentNode> MainWindow::searchKeyword(const QString& keyword)
 {
-    QVector<DocumentNode> results;
-    QSet<int> addedDocs;  // 用于去重
-    
-    // 对搜索关键词进行分词
-    QStringList searchTokens = tokenize(keyword);
-    
-    // 搜索每个分词结果
-    for (const QString& token : searchTokens) {
-        // 在跳表中查找关键词
-        InvertedIndexNode* node = invertedIndex.find(token);
-        if (node) {
-            // 添加未重复的文档
-            for (const DocumentNode& doc : node->documents) {
-                if (!addedDocs.contains(doc.docId)) {
-                    results.append(doc);
-                    addedDocs.insert(doc.docId);
-                }
-            }
-        }
-    }
-    
-    return results;
+    // 各分词的BM25得分按文档累加，只保留得分最高的前100个文档，已按得分降序排列
+    return queryEngine.search(keyword, 100);
 }
 
 void MainWindow::performSearch()
@@ -715,10 +449,7 @@ void MainWindow::performSearch()
         return;
     }
     
-    // 对结果进行排序
-    rankResults(results);
-    
-    // 显示搜索结果
+    // 显示搜索结果，摘要只为实际显示的结果生成
     QSet<int> displayedDocs; // 用于跟踪已显示的文档，避免重复
     
     for (const DocumentNode& node : results) {
@@ -727,8 +458,9 @@ void MainWindow::performSearch()
             continue;
         }
         
-        QFileInfo fileInfo(documentPaths[node.docId]);
-        QString fileName = fileInfo.fileName();
+        QString filePath = index.documentPath(node.docId);
+        QString fileName = QFileInfo(filePath).fileName();
+        TokenSpan span = index.tokenSpan(node.docId, node.position, node.length);
         
         // 创建列表项
         QListWidgetItem* item = new QListWidgetItem();
@@ -739,11 +471,12 @@ void MainWindow::performSearch()
                                    "<div style='margin-top:3px; color:#555;'>%2</div>"
                                    "</div>")
                          .arg(fileName)
-                         .arg(QString(node.context).replace('\n', ' '));
+                         .arg(extractContext(documentContent(filePath), span));
         
         item->setText(itemText);
-        item->setData(Qt::UserRole, node.docId);
-        item->setData(Qt::UserRole + 1, node.position);
+        item->setData(Qt::UserRole, filePath);
+        item->setData(Qt::UserRole + 1, span.start);
+        item->setData(Qt::UserRole + 2, span.length);
         
         // 设置图标
         item->setIcon(style()->standardIcon(QStyle::SP_FileIcon));
@@ -761,41 +494,21 @@ void MainWindow::performSearch()
     statusLabel->setText(QString("🔍 找到 %1 个匹配文档").arg(displayedDocs.size()));
 }
 
-void MainWindow::rankResults(QVector<DocumentNode>& results)
+QString MainWindow::extractContext(const QString& content, const TokenSpan& span)
 {
-    // 对搜索结果进行排序
-    // 这里使用简单的权重排序，可以扩展为更复杂的PageRank算法或相似度算法
-    std::sort(results.begin(), results.end(), [](const DocumentNode& a, const DocumentNode& b) {
-        return a.weight > b.weight; // 按权重降序排序
-    });
+    // 根据词位置表直接截取原文，不需要重新分词；短语匹配时高亮整个短语
+    return SnippetBuilder::build(content, span);
 }
 
-QString MainWindow::extractContext(const QString& content, int position, int contextSize)
+QString MainWindow::documentContent(const QString& filePath)
 {
-    // 从文档内容中提取关键词的上下文
-    QStringList tokens = tokenize(content);
-    
-    // 确保位置有效
-    if (position < 0 || position >= tokens.size()) {
-        return QString();
+    // 原文不在内存中，第一次显示时读取文件并缓存
+    if (QString* cached = contentCache.object(filePath)) {
+        return *cached;
     }
-    
-    // 确定上下文的起始和结束位置
-    int start = qMax(0, position - contextSize / 2);
-    int end = qMin(tokens.size() - 1, position + contextSize / 2);
-    
-    // 构建上下文字符串
-    QString context;
-    for (int i = start; i <= end; ++i) {
-        if (i == position) {
-            // 高亮显示关键词
-            context += "<b style='color:red;'>" + tokens[i] + "</b> ";
-        } else {
-            context += tokens[i] + " ";
-        }
-    }
-    
-    return context.trimmed() + "...";
+    QString content = readFileContent(filePath);
+    contentCache.insert(filePath, new QString(content), qMax(1, static_cast<int>(content.size())));
+    return content;
 }
 
 void MainWindow::displayFileContent()
@@ -805,31 +518,19 @@ void MainWindow::displayFileContent()
         return;
     }
     
-    int docId = item->data(Qt::UserRole).toInt();
-    int position = item->data(Qt::UserRole + 1).toInt();
-    
-    if (docId < 0 || docId >= documentContents.size()) {
+    QString filePath = item->data(Qt::UserRole).toString();
+    TokenSpan span(item->data(Qt::UserRole + 1).toInt(), item->data(Qt::UserRole + 2).toInt());
+    if (filePath.isEmpty()) {
         return;
     }
     
     // 获取文件内容和文件名
-    QString content = documentContents[docId];
-    QFileInfo fileInfo(documentPaths[docId]);
-    QString fileName = fileInfo.fileName();
-    
-    // 显示文件内容，并高亮显示关键词
-    QStringList tokens = tokenize(content);
-    QString displayContent = QString("<h3>%1</h3><hr>").arg(fileName);
-    
-    // 在文本中高亮显示关键词
-    for (int i = 0; i < tokens.size(); ++i) {
-        if (i == position) {
-            // 高亮显示关键词
-            displayContent += "<span style='background-color:yellow;'>" + tokens[i] + "</span> ";
-        } else {
-            displayContent += tokens[i] + " ";
-        }
-    }
+    QString content = documentContent(filePath);
+    QString fileName = QFileInfo(filePath).fileName();
+    
+    // 显示文件原文，并高亮显示关键词
+    QString displayContent = QString("<h3>%1</h3><hr>").arg(fileName.toHtmlEscaped())
+                           + SnippetBuilder::highlightDocument(content, span);
     
     fileContentView->setHtml(displayContent);
 }
@@ -851,30 +552,38 @@ void MainWindow::clearSearch()
 
 void MainWindow::clearIndex()
 {
-    // 清除Trie树
-    if (root) {
-        // 递归删除所有节点
-        std::function<void(TrieNode*)> deleteNode = [&](TrieNode* node) {
-            if (!node) return;
-            
-            for (auto it = node->children.begin(); it != node->children.end(); ++it) {
-                deleteNode(it.value());
-            }
-            
-            delete node;
-        };
-        
-        for (auto it = root->children.begin(); it != root->children.end(); ++it) {
-            deleteNode(it.value());
-        }
-        
-        root->children.clear();
-    }
-    
-    // 清除其他数据
+    // 清除内存中的数据
     documentPaths.clear();
-    documentContents.clear();
-    invertedIndex.clear();
+    contentCache.clear();
 }
 
+QString MainWindow::indexDirectory() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/index";
+}
 
+void MainWindow::openIndex()
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    // 索引可以由导入的文件重新建立，无法打开时清空索引目录重新开始
+    QString error;
+    if (!index.open(indexDirectory(), &error)) {
+        qDebug() << error;
+        QDir(indexDirectory()).removeRecursively();
+        index.open(indexDirectory());
+        statusLabel->setText("⚠️ 上次保存的索引无法加载，请重新导入文件");
+        return;
+    }
+    
+    // 查询直接在映射的段上进行，原文在显示结果时再读取
+    queryEngine.setSegments(index.searchSegments());
+    if (index.liveDocumentCount() > 0) {
+        statusLabel->setText(QString("✓ 已加载上次的索引: %1 个文件，%2 个段 (用时: %3 毫秒)")
+                           .arg(index.liveDocumentCount())
+                           .arg(index.segmentCount())
+                           .arg(timer.elapsed()));
+    }
+    startMerge();
+}
@@ -9,8 +9,11 @@
 #include <QTextStream>
 #include <QDir>
 #include <QSet>
+#include <QHash>
 #include <QFileInfo>
 #include <QLineEdit>
+#include <QCompleter>
+#include <QStringListModel>
 #include <QPushButton>
 #include <QListWidget>
 #include <QTextEdit>
@@ -29,20 +32,16 @@
 #include <QFutureWatcher>
 #include <QElapsedTimer>
 #include <QPair>
+#include <QCache>
+#include "documentreader.h"
 #include "invertedindexnode.h"
 #include "skiplist.h"
-
-// 在InvertedIndexNode结构体后添加新的结构体
-struct IndexBatch {
-    QVector<InvertedIndexNode> nodes;
-    QMap<QString, int> keywordMap;
-};
-
-struct BatchRange {
-    int start;
-    int end;
-    BatchRange(int s, int e) : start(s), end(e) {}
-};
+#include "indexbuilder.h"
+#include "incrementalindex.h"
+#include "ingestpipeline.h"
+#include "indexreader.h"
+#include "queryengine.h"
+#include "snippetbuilder.h"
 
 class MainWindow : public QMainWindow
 {
@@ -61,12 +60,17 @@ private slots:
     void displayFileContent();        // 显示文件内容
     void clearSearch();               // 清空搜索
     void updateProgressUI(int value, int maximum, const QString& message); // 更新进度UI
-    void handleFilesLoaded();         // 处理文件加载完成事件
-    void handleIndexingFinished();    // 处理索引完成的槽
+    void handleIndexingFinished();    // 一部分文件的索引建立完成
+    void handleMergeFinished();       // 后台段合并完成
+    void updateCompletions(const QString& text); // 按输入的前缀更新自动补全候选
 
 private:
+    static const int CONTENT_CACHE_SIZE = 16 * 1024 * 1024;   // 原文缓存的最大字符数
+
     // UI组件
     QLineEdit* searchBox;             // 搜索框
+    QCompleter* completer;            // 搜索框的自动补全
+    QStringListModel* completionModel; // 自动补全的候选词
     QPushButton* searchButton;        // 搜索按钮
     QPushButton* importButton;        // 导入按钮
     QPushButton* clearButton;         // 清空按钮
@@ -76,31 +80,34 @@ private:
     QLabel* statusLabel;              // 状态标签
 
     // 数据成员
-    QVector<QString> documentPaths;   // 文档路径列表
-    QVector<QString> documentContents; // 文档内容列表
-    SkipList invertedIndex;           // 使用跳表存储倒排索引
-    TrieNode* root;                   // 词典树根节点
+    QVector<QString> documentPaths;   // 本次导入（新增或修改）的文档路径
+    FolderChanges pendingChanges;     // 本次导入的文件夹相对索引的变化
+    QList<QStringList> pendingParts;  // 本次导入还没有建立索引的部分，每部分提交为一个段
+    int ingestedFiles;                // 本次导入已处理的文件数（包括无法读取的文件）
+    int importedDocuments;            // 本次导入已加入索引的文档数
+    TermDictionary termDictionary;    // 建立索引的各线程直接写入的并发词典
+    IncrementalIndex index;           // 增量索引：段文件加上删除标记
+    QueryEngine queryEngine;          // BM25打分和前k名检索
+    QCache<QString, QString> contentCache; // 最近显示过的文档原文，按路径缓存
     
     // 异步处理成员
-    QFutureWatcher<QPair<QVector<QString>, QVector<QString>>>* fileLoadWatcher;  // 文件加载完成监视器
-    QFutureWatcher<IndexBatch>* indexWatcher;  // 索引构建监视器
+    QFutureWatcher<IngestResult>* ingestWatcher;  // 流式导入监视器
+    QFutureWatcher<MergeResult>* mergeWatcher; // 后台段合并监视器
     QElapsedTimer processTimer;       // 处理时间计时器
     
     // 功能方法
     void createUI();                  // 创建用户界面
     QString readFileContent(const QString& filePath); // 读取文件内容
-    QStringList tokenize(const QString& content);   // 分词方法
     void buildInvertedIndex();        // 建立倒排索引
-    void loadFilesAsync(const QStringList& fileNames, const QDir& directory); // 异步加载文件
-    void insertToTrie(const QString& word, int indexId); // 向词典树中插入单词
-    int searchInTrie(const QString& word);          // 在词典树中搜索单词
     QVector<DocumentNode> searchKeyword(const QString& keyword); // 搜索关键词
-    void rankResults(QVector<DocumentNode>& results); // 对结果进行排序
-    QString extractContext(const QString& content, int position, int contextSize = 50); // 提取上下文
-    void clearIndex();                // 清空索引
-    void buildInvertedIndexParallel();  // 并行构建索引
-    IndexBatch processBatch(const BatchRange& range);  // 处理单个批次
+    QString extractContext(const QString& content, const TokenSpan& span); // 提取上下文摘要
+    QString documentContent(const QString& filePath); // 文档原文，在第一次显示时读取
+    void clearIndex();                // 清空内存中的数据（不删除已保存的索引）
+    void startIngest();               // 在后台为下一部分文件建立索引
     void mergeIndexResults(const QList<IndexBatch>& results);  // 合并索引结果
+    QString indexDirectory() const;   // 索引目录的保存位置
+    void openIndex();                 // 启动时打开上次保存的索引
+    void startMerge();                // 有需要合并的段时在后台开始合并
     
 
 };
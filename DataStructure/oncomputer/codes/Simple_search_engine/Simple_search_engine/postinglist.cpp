@@ -0,0 +1,224 @@
+#include "postinglist.h"
+
+PostingIterator::PostingIterator(const char* data, int size)
+    : p(reinterpret_cast<const uchar*>(data)),
+      end(reinterpret_cast<const uchar*>(data) + size),
+      blockEnd(p), blockLastDoc(-1),
+      remainingInBlock(0), atBlockStart(false),
+      currentDoc(-1), tf(0), positionsStart(nullptr), positionsPending(false)
+{
+}
+
+bool PostingIterator::readBlockHeader()
+{
+    if (!p || p >= end) {
+        currentDoc = NO_MORE_DOCS;
+        positionsPending = false;
+        return false;
+    }
+
+    blockLastDoc = static_cast<int>(VarInt::decode(p));
+    remainingInBlock = static_cast<int>(VarInt::decode(p));
+    int bodySize = static_cast<int>(VarInt::decode(p));
+    blockEnd = p + bodySize;
+    atBlockStart = true;
+    return true;
+}
+
+bool PostingIterator::next()
+{
+    // 跳过上一个文档未读取的位置数据
+    if (positionsPending) {
+        skipPositions();
+    }
+
+    // 当前块已读完，读取下一个块头
+    if (remainingInBlock == 0 && !readBlockHeader()) {
+        return false;
+    }
+
+    quint32 value = VarInt::decode(p);
+    currentDoc = atBlockStart ? static_cast<int>(value) : currentDoc + static_cast<int>(value);
+    atBlockStart = false;
+    tf = static_cast<int>(VarInt::decode(p));
+    positionsStart = p;
+    positionsPending = true;
+    remainingInBlock--;
+    return true;
+}
+
+bool PostingIterator::advanceTo(int target)
+{
+    if (currentDoc >= target) {
+        return currentDoc != NO_MORE_DOCS;
+    }
+    if (positionsPending) {
+        skipPositions();
+    }
+
+    // 当前块中没有满足条件的文档，直接跳到块尾
+    if (remainingInBlock > 0 && blockLastDoc < target) {
+        p = blockEnd;
+        remainingInBlock = 0;
+    }
+
+    // 根据块头中的最后一个docId整块跳过，不解码块体
+    if (remainingInBlock == 0) {
+        while (readBlockHeader()) {
+            if (blockLastDoc >= target) {
+                break;
+            }
+            p = blockEnd;
+            remainingInBlock = 0;
+        }
+        if (currentDoc == NO_MORE_DOCS) {
+            return false;
+        }
+    }
+
+    // 目标一定在当前块内
+    while (next()) {
+        if (currentDoc >= target) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QVector<int> PostingIterator::positions()
+{
+    QVector<int> result;
+    if (currentDoc < 0 || currentDoc == NO_MORE_DOCS) {
+        return result;
+    }
+
+    // 位置从positionsStart开始解码，同一文档可以重复读取
+    const uchar* q = positionsStart;
+    result.reserve(tf);
+    int position = 0;
+    for (int i = 0; i < tf; ++i) {
+        position += static_cast<int>(VarInt::decode(q));
+        result.append(position);
+    }
+    if (positionsPending) {
+        p = q;
+        positionsPending = false;
+    }
+    return result;
+}
+
+void PostingIterator::skipPositions()
+{
+    for (int i = 0; i < tf; ++i) {
+        VarInt::skip(p);
+    }
+    positionsPending = false;
+}
+
+PostingList::PostingList()
+    : pendingCount(0), docCount(0), maxTf(0), lastDoc(-1)
+{
+}
+
+void PostingList::add(int docId, const QVector<int>& positions)
+{
+    add(docId, positions.constData(), positions.size());
+}
+
+void PostingList::add(int docId, const int* positions, int count)
+{
+    // 块内第一个文档存绝对docId，其余存差值
+    VarInt::encode(pendingBody, pendingCount == 0 ? docId : docId - lastDoc);
+    VarInt::encode(pendingBody, count);
+
+    int previous = 0;
+    for (int i = 0; i < count; ++i) {
+        VarInt::encode(pendingBody, positions[i] - previous);
+        previous = positions[i];
+    }
+
+    lastDoc = docId;
+    maxTf = qMax(maxTf, count);
+    docCount++;
+
+    if (++pendingCount == BLOCK_SIZE) {
+        flushBlock();
+    }
+}
+
+void PostingList::flushBlock()
+{
+    if (pendingCount == 0) {
+        return;
+    }
+
+    VarInt::encode(bytes, lastDoc);
+    VarInt::encode(bytes, pendingCount);
+    VarInt::encode(bytes, pendingBody.size());
+    bytes.append(pendingBody);
+
+    pendingBody.clear();
+    pendingCount = 0;
+}
+
+void PostingList::finish()
+{
+    flushBlock();
+    pendingBody = QByteArray();
+    bytes.squeeze();
+}
+
+void PostingList::append(const PostingList& other)
+{
+    if (other.isEmpty()) {
+        return;
+    }
+
+    // 块是自包含的，写出本表未满的块后直接拼接字节即可
+    flushBlock();
+    bytes.append(other.bytes);
+    docCount += other.docCount;
+    maxTf = qMax(maxTf, other.maxTf);
+    lastDoc = other.lastDoc;
+}
+
+void PostingList::appendShared(const PostingList& other, const char* data)
+{
+    Q_ASSERT(pendingCount == 0);
+    bytes = QByteArray::fromRawData(data, bytes.size() + other.bytes.size());
+    if (!other.isEmpty()) {
+        docCount += other.docCount;
+        maxTf = qMax(maxTf, other.maxTf);
+        lastDoc = other.lastDoc;
+    }
+}
+
+void PostingList::clear()
+{
+    bytes.clear();
+    pendingBody.clear();
+    pendingCount = 0;
+    docCount = 0;
+    maxTf = 0;
+    lastDoc = -1;
+}
+
+PostingIterator PostingList::iterator() const
+{
+    return PostingIterator(bytes.constData(), bytes.size());
+}
+
+PostingView PostingList::view() const
+{
+    PostingView result;
+    result.data = bytes.constData();
+    result.size = bytes.size();
+    result.documentFrequency = docCount;
+    result.maxTermFrequency = maxTf;
+    return result;
+}
+
+qint64 PostingList::memoryUsage() const
+{
+    return sizeof(PostingList) + bytes.capacity() + pendingBody.capacity();
+}
@@ -0,0 +1,121 @@
+#ifndef POSTINGLIST_H
+#define POSTINGLIST_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+// 变长整数编码：每个字节低7位存数据，最高位为1表示后面还有字节
+namespace VarInt {
+    inline void encode(QByteArray& out, quint32 value)
+    {
+        while (value >= 0x80) {
+            out.append(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.append(static_cast<char>(value));
+    }
+
+    inline quint32 decode(const uchar*& p)
+    {
+        quint32 value = *p & 0x7F;
+        int shift = 7;
+        while (*p++ & 0x80) {
+            value |= static_cast<quint32>(*p & 0x7F) << shift;
+            shift += 7;
+        }
+        return value;
+    }
+
+    inline void skip(const uchar*& p)
+    {
+        while (*p++ & 0x80) {
+        }
+    }
+}
+
+// 倒排表迭代器，直接在压缩字节上逐个解码文档，不展开整张表
+//
+// 压缩格式按块组织，每块最多 PostingList::BLOCK_SIZE 个文档：
+//   块头: varint(块内最后一个docId) varint(块内文档数) varint(块体字节数)
+//   块体: 每个文档依次为 varint(docId) varint(词频tf) tf个varint(位置)
+//         块内第一个docId存绝对值，其余存与前一个docId的差值；
+//         位置同样按差值存储，第一个位置存绝对值
+// 每块自包含，两张docId不重叠的表可以直接拼接字节
+class PostingIterator {
+public:
+    static constexpr int NO_MORE_DOCS = 0x7FFFFFFF;   // 遍历结束后docId()的值
+
+    PostingIterator(const char* data = nullptr, int size = 0);
+
+    bool next();                       // 移动到下一个文档，没有更多文档时返回false
+    bool advanceTo(int target);        // 移动到第一个docId >= target的文档，整块跳过不满足的块
+    int docId() const { return currentDoc; }
+    int termFrequency() const { return tf; }
+    QVector<int> positions();          // 解码当前文档中的全部位置
+
+private:
+    bool readBlockHeader();
+    void skipPositions();
+
+    const uchar* p;                    // 当前读取位置
+    const uchar* end;                  // 数据末尾
+    const uchar* blockEnd;             // 当前块的末尾
+    int blockLastDoc;                  // 当前块中最后一个docId
+    int remainingInBlock;              // 当前块中剩余未读取的文档数
+    bool atBlockStart;                 // 下一个文档是否为块内第一个文档
+    int currentDoc;
+    int tf;
+    const uchar* positionsStart;       // 当前文档位置数据的起点
+    bool positionsPending;             // 当前文档的位置数据是否还未被跳过
+};
+
+// 只读的倒排表：压缩字节和统计信息，可以指向内存中的PostingList，也可以指向映射到内存的段文件
+struct PostingView {
+    const char* data = nullptr;
+    int size = 0;
+    int documentFrequency = 0;
+    int maxTermFrequency = 0;
+
+    PostingIterator iterator() const { return PostingIterator(data, size); }
+    bool isEmpty() const { return documentFrequency == 0; }
+};
+
+// 压缩倒排表：按docId递增顺序追加文档，写满一块后编码进字节数组
+class PostingList {
+public:
+    static const int BLOCK_SIZE = 128;
+
+    PostingList();
+
+    void add(int docId, const QVector<int>& positions);  // docId必须严格递增
+    void add(int docId, const int* positions, int count);
+    void finish();                                       // 写出未满的块并释放多余容量
+    void append(const PostingList& other);               // 拼接另一张已finish的表，其docId必须都大于本表
+    // 与append相同，但拼接后的字节由调用者写在data中（本表的字节之后紧接other的字节），
+    // 本表只引用data而不复制；本表必须已finish，data在本表及其副本使用期间必须有效且不再改变
+    void appendShared(const PostingList& other, const char* data);
+    void clear();
+
+    PostingIterator iterator() const;
+    PostingView view() const;                            // 只包含已写出的块，使用前应先finish
+
+    int documentFrequency() const { return docCount; }  // 包含该词的文档数
+    int maxTermFrequency() const { return maxTf; }       // 单个文档中的最大词频
+    int lastDocId() const { return lastDoc; }
+    bool isEmpty() const { return docCount == 0; }
+    const QByteArray& data() const { return bytes; }
+    qint64 memoryUsage() const;                          // 估算占用的字节数
+
+private:
+    void flushBlock();
+
+    QByteArray bytes;         // 已编码的完整块
+    QByteArray pendingBody;   // 正在填充的块体
+    int pendingCount;         // 正在填充的块中的文档数
+    int docCount;
+    int maxTf;
+    int lastDoc;
+};
+
+#endif // POSTINGLIST_H
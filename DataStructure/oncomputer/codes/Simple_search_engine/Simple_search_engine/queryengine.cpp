@@ -0,0 +1,654 @@
+#include "queryengine.h"
+#include "levenshteinautomaton.h"
+#include <QPair>
+#include <QSet>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+namespace {
+    // 一个查询词的倒排表游标
+    struct TermCursor {
+        PostingIterator it;
+        double idf;
+        double upperBound;   // 该词在任意文档中的最高得分
+    };
+
+    // 按当前docId升序排列游标，查询词很少，用插入排序即可
+    void sortByDocId(QVector<TermCursor*>& cursors)
+    {
+        for (int i = 1; i < cursors.size(); ++i) {
+            TermCursor* cursor = cursors[i];
+            int j = i - 1;
+            while (j >= 0 && cursors[j]->it.docId() > cursor->it.docId()) {
+                cursors[j + 1] = cursors[j];
+                --j;
+            }
+            cursors[j + 1] = cursor;
+        }
+    }
+
+    // 缓存的键：分词后的语法树，与原查询中的空白、大小写和多余的括号无关
+    void appendKey(const QueryNodePtr& node, QString& key)
+    {
+        static const char TYPES[] = { 't', 'p', 'n', '&', '|', '!', 'w' };
+        key += QChar(TYPES[node->type]);
+        if (node->type == QueryNode::Term || node->type == QueryNode::Wildcard) {
+            key += node->term;
+            key += QChar(0x1F);
+            return;
+        }
+        if (node->type == QueryNode::Near) {
+            key += QString::number(node->distance);
+        }
+        key += QChar('(');
+        for (const QueryNodePtr& child : node->children) {
+            if (node->type == QueryNode::Phrase) {
+                key += QString::number(child->offset);
+            }
+            appendKey(child, key);
+        }
+        key += QChar(')');
+    }
+}
+
+QueryEngine::QueryEngine(const IndexReader* reader)
+    : indexGeneration(0), liveDocuments(0), parallelThreshold(PARALLEL_MIN_DOCUMENTS),
+      wildcardPatterns(0), wildcardMatches(0), wildcardTruncated(0)
+{
+    if (reader) {
+        setReader(reader);
+    }
+}
+
+void QueryEngine::setReader(const IndexReader* reader)
+{
+    SearchSegment segment;
+    segment.reader = reader;
+    setSegments(QVector<SearchSegment>() << segment);
+}
+
+void QueryEngine::setSegments(const QVector<SearchSegment>& segments)
+{
+    searchSegments = segments;
+    updateStatistics();
+}
+
+void QueryEngine::updateStatistics()
+{
+    int count = 0;
+    qint64 totalLength = 0;
+    int minLength = 0;
+    for (const SearchSegment& segment : searchSegments) {
+        for (int docId = 0; docId < segment.reader->documentCount(); ++docId) {
+            if (segment.isDeleted(docId)) {
+                continue;
+            }
+            int length = segment.reader->documentLength(docId);
+            totalLength += length;
+            minLength = count > 0 ? qMin(minLength, length) : length;
+            count++;
+        }
+    }
+
+    double averageLength = count > 0 ? static_cast<double>(totalLength) / count : 0.0;
+    bm25.setCollection(count, averageLength, minLength);
+    liveDocuments = count;
+    indexGeneration++;
+}
+
+bool QueryEngine::isParallel() const
+{
+    return searchSegments.size() > 1 && liveDocuments >= parallelThreshold;
+}
+
+QVector<DocumentNode> QueryEngine::scatterGather(const SegmentSearch& search, int topK) const
+{
+    if (!isParallel()) {
+        TopKHeap heap(topK);
+        for (const SearchSegment& segment : searchSegments) {
+            search(segment, heap);
+        }
+        return heap.takeSorted();
+    }
+
+    // 各段用自己的堆，前k名的门槛只在段内提高，WAND跳过的文档比共用一个堆时少，
+    // 但各段互不等待；调用线程也参与求值
+    struct Shard {
+        const SearchSegment* segment;
+        QVector<DocumentNode> results;
+    };
+    QVector<Shard> shards;
+    for (const SearchSegment& segment : searchSegments) {
+        Shard shard = { &segment, QVector<DocumentNode>() };
+        shards.append(shard);
+    }
+    QtConcurrent::blockingMap(shards, [&search, topK](Shard& shard) {
+        TopKHeap heap(topK);
+        search(*shard.segment, heap);
+        shard.results = heap.takeSorted();
+    });
+
+    QVector<QVector<DocumentNode>> lists;
+    for (Shard& shard : shards) {
+        lists.append(shard.results);
+    }
+    return TopKHeap::merge(lists, topK);
+}
+
+double QueryEngine::termIdf(const QString& term) const
+{
+    // 已删除的文档在段合并前仍计入文档频率
+    int documentFrequency = 0;
+    for (const SearchSegment& segment : searchSegments) {
+        documentFrequency += segment.reader->postings(term).documentFrequency;
+    }
+    return bm25.idf(documentFrequency);
+}
+
+double QueryEngine::cachedIdf(const QString& term, QHash<QString, double>& idfs) const
+{
+    auto it = idfs.constFind(term);
+    if (it != idfs.constEnd()) {
+        return it.value();
+    }
+    double idf = termIdf(term);
+    idfs.insert(term, idf);
+    return idf;
+}
+
+QVector<QueryEngine::FuzzyTerm> QueryEngine::fuzzyExpansions(const QString& term) const
+{
+    QVector<FuzzyTerm> expansions;
+    int maxEdits = LevenshteinAutomaton::editsForLength(term.length());
+    if (maxEdits == 0) {
+        return expansions;
+    }
+    for (const SearchSegment& segment : searchSegments) {
+        if (!segment.reader->postings(term).isEmpty()) {
+            return expansions;
+        }
+    }
+
+    // 同一个词在各段中的距离相同，文档频率相加
+    LevenshteinAutomaton automaton(term, maxEdits);
+    QHash<QString, QPair<int, int>> matches;   // 词 -> (距离, 文档频率)
+    for (const SearchSegment& segment : searchSegments) {
+        segment.reader->forEachFuzzyTerm(automaton, [&matches](const QString& match, int distance, const PostingView& postings) {
+            QPair<int, int>& entry = matches[match];
+            entry.first = distance;
+            entry.second += postings.documentFrequency;
+        });
+    }
+
+    // 按(距离, -文档频率, 词)升序取前MAX_FUZZY_EXPANSIONS个
+    QVector<QPair<QPair<int, int>, QString>> candidates;
+    candidates.reserve(matches.size());
+    for (auto it = matches.constBegin(); it != matches.constEnd(); ++it) {
+        candidates.append(qMakePair(qMakePair(it.value().first, -it.value().second), it.key()));
+    }
+    int count = qMin(static_cast<int>(MAX_FUZZY_EXPANSIONS), static_cast<int>(candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+    for (int i = 0; i < count; ++i) {
+        FuzzyTerm expansion;
+        expansion.term = candidates[i].second;
+        expansion.distance = candidates[i].first.first;
+        expansion.boost = 1.0 - static_cast<double>(expansion.distance) / qMin(term.length(), expansion.term.length());
+        expansions.append(expansion);
+    }
+    return expansions;
+}
+
+QueryNodePtr QueryEngine::expandFuzzy(const QueryNodePtr& node) const
+{
+    // 短语和NEAR要比较位置，NOT之下扩展会多排除文档，这些节点保持原样
+    switch (node->type) {
+    case QueryNode::Term: {
+        QVector<FuzzyTerm> expansions = fuzzyExpansions(node->term);
+        if (expansions.isEmpty()) {
+            return node;
+        }
+        QueryNodePtr alternatives(new QueryNode(QueryNode::Or));
+        for (const FuzzyTerm& expansion : expansions) {
+            QueryNodePtr child(new QueryNode(QueryNode::Term, expansion.term));
+            child->boost = expansion.boost;
+            alternatives->children.append(child);
+        }
+        return alternatives;
+    }
+
+    case QueryNode::And:
+    case QueryNode::Or: {
+        QueryNodePtr copy(new QueryNode(*node));
+        for (QueryNodePtr& child : copy->children) {
+            child = expandFuzzy(child);
+        }
+        return copy;
+    }
+
+    default:
+        return node;
+    }
+}
+
+QStringList QueryEngine::complete(const QString& prefix, int limit) const
+{
+    // 索引词为小写；已删除的文档在段合并前仍计入文档频率
+    QString key = prefix.toLower();
+    if (key.isEmpty() || limit <= 0) {
+        return QStringList();
+    }
+
+    QHash<QString, int> frequencies;
+    for (const SearchSegment& segment : searchSegments) {
+        segment.reader->forEachTermWithPrefix(key, [&frequencies](const QString& term, const PostingView& postings) {
+            frequencies[term] += postings.documentFrequency;
+        });
+    }
+    return mostFrequent(frequencies, limit);
+}
+
+QStringList QueryEngine::expandWildcard(const QString& pattern, int limit, int* matchCount) const
+{
+    QHash<QString, int> frequencies;
+    for (const SearchSegment& segment : searchSegments) {
+        segment.reader->forEachWildcardTerm(pattern, [&frequencies](const QString& term, const PostingView& postings) {
+            frequencies[term] += postings.documentFrequency;
+        });
+    }
+
+    wildcardPatterns++;
+    wildcardMatches += frequencies.size();
+    if (frequencies.size() > limit) {
+        wildcardTruncated++;
+    }
+    if (matchCount) {
+        *matchCount = frequencies.size();
+    }
+    return mostFrequent(frequencies, limit);
+}
+
+QueryEngine::WildcardStats QueryEngine::wildcardStats() const
+{
+    WildcardStats stats;
+    stats.patterns = wildcardPatterns.load();
+    stats.matchedTerms = wildcardMatches.load();
+    stats.truncatedPatterns = wildcardTruncated.load();
+    return stats;
+}
+
+QueryNodePtr QueryEngine::expandWildcards(const QueryNodePtr& node) const
+{
+    // NOT之下也要扩展：匹配任意一个扩展词的文档都被排除；没有匹配的词时为空的OR，不匹配任何文档
+    if (node->type == QueryNode::Wildcard) {
+        QueryNodePtr alternatives(new QueryNode(QueryNode::Or));
+        for (const QString& term : expandWildcard(node->term)) {
+            alternatives->children.append(QueryNodePtr(new QueryNode(QueryNode::Term, term)));
+        }
+        return alternatives->children.size() == 1 ? alternatives->children.first() : alternatives;
+    }
+    if (node->children.isEmpty()) {
+        return node;
+    }
+    QueryNodePtr copy(new QueryNode(*node));
+    for (QueryNodePtr& child : copy->children) {
+        child = expandWildcards(child);
+    }
+    return copy;
+}
+
+QStringList QueryEngine::mostFrequent(const QHash<QString, int>& frequencies, int limit)
+{
+    // 文档频率取负后升序排列，频率相同时按词排序
+    QVector<QPair<int, QString>> candidates;
+    candidates.reserve(frequencies.size());
+    for (auto it = frequencies.constBegin(); it != frequencies.constEnd(); ++it) {
+        candidates.append(qMakePair(-it.value(), it.key()));
+    }
+    int count = qMin(limit, static_cast<int>(candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+    QStringList terms;
+    for (int i = 0; i < count; ++i) {
+        terms.append(candidates[i].second);
+    }
+    return terms;
+}
+
+QVector<DocumentNode> QueryEngine::search(const QString& query, int topK) const
+{
+    // 没有运算符时各词之间为OR
+    bool boolean = QueryParser::isBooleanQuery(query);
+    QueryNodePtr root = QueryParser::parse(query, boolean ? QueryNode::And : QueryNode::Or);
+    if (!root) {
+        return QVector<DocumentNode>();
+    }
+
+    QString key = QString::number(topK) + QChar(':');
+    appendKey(root, key);
+    QVector<DocumentNode> results;
+    if (cache.find(key, indexGeneration, results)) {
+        return results;
+    }
+
+    // 没有运算符且全部是单个索引词或通配符时走WAND，通配符扩展出的词与其他词一起OR合并；
+    // 含有短语（如中文词）时按语法树求值
+    QStringList terms;
+    bool flat = !boolean;
+    QVector<QueryNodePtr> words = root->type == QueryNode::Or ? root->children : QVector<QueryNodePtr>() << root;
+    for (int i = 0; flat && i < words.size(); ++i) {
+        if (words[i]->type == QueryNode::Term) {
+            terms.append(words[i]->term);
+        } else if (words[i]->type == QueryNode::Wildcard) {
+            terms.append(expandWildcard(words[i]->term));
+        } else {
+            flat = false;
+        }
+    }
+    if (!flat) {
+        results = searchQuery(root, topK);
+    } else if (!terms.isEmpty()) {
+        results = searchTerms(terms, topK);
+    }
+
+    cache.insert(key, indexGeneration, results);
+    return results;
+}
+
+QVector<DocumentNode> QueryEngine::searchTerms(const QStringList& terms, int topK) const
+{
+    // 去掉重复的查询词，idf对所有段相同；
+    // 得分与idf成正比，拼写纠正扩展出的词直接把idf乘以boost
+    QStringList uniqueTerms;
+    QVector<double> idfs;
+    QSet<QString> seen;
+    auto addTerm = [&](const QString& term, double boost) {
+        if (seen.contains(term)) {
+            return;
+        }
+        seen.insert(term);
+        uniqueTerms.append(term);
+        idfs.append(termIdf(term) * boost);
+    };
+    for (const QString& term : terms) {
+        QVector<FuzzyTerm> expansions = fuzzyExpansions(term);
+        if (expansions.isEmpty()) {
+            addTerm(term, 1.0);
+        }
+        for (const FuzzyTerm& expansion : expansions) {
+            addTerm(expansion.term, expansion.boost);
+        }
+    }
+
+    return scatterGather([&](const SearchSegment& segment, TopKHeap& heap) {
+        searchTermsInSegment(segment, uniqueTerms, idfs, heap);
+    }, topK);
+}
+
+void QueryEngine::searchTermsInSegment(const SearchSegment& segment, const QStringList& terms,
+                                       const QVector<double>& idfs, TopKHeap& heap) const
+{
+    // 为段中出现的每个查询词建立游标
+    QVector<TermCursor> cursors;
+    cursors.reserve(terms.size());
+    for (int i = 0; i < terms.size(); ++i) {
+        PostingView postings = segment.reader->postings(terms[i]);
+        if (postings.isEmpty()) {
+            continue;
+        }
+
+        TermCursor cursor;
+        cursor.it = postings.iterator();
+        cursor.idf = idfs[i];
+        cursor.upperBound = bm25.upperBound(cursor.idf, postings.maxTermFrequency);
+        cursor.it.next();
+        cursors.append(cursor);
+    }
+
+    QVector<TermCursor*> order;
+    order.reserve(cursors.size());
+    for (TermCursor& cursor : cursors) {
+        order.append(&cursor);
+    }
+
+    while (true) {
+        sortByDocId(order);
+
+        // 找到枢轴：按docId顺序累加上界，第一个使累加和超过门槛的游标。
+        // 枢轴之前的游标即使全部命中同一文档也进不了前k名
+        double threshold = heap.threshold();
+        double bound = 0.0;
+        int pivot = -1;
+        for (int i = 0; i < order.size(); ++i) {
+            if (order[i]->it.docId() == PostingIterator::NO_MORE_DOCS) {
+                break;
+            }
+            bound += order[i]->upperBound;
+            if (bound > threshold) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot < 0) {
+            break;
+        }
+
+        int pivotDoc = order[pivot]->it.docId();
+        if (order[0]->it.docId() != pivotDoc) {
+            // 把枢轴之前的游标直接跳到枢轴文档，跳过的文档不需要打分
+            for (int i = 0; i < pivot; ++i) {
+                order[i]->it.advanceTo(pivotDoc);
+            }
+            continue;
+        }
+
+        // 所有位于枢轴文档的游标一起打分，已删除的文档只移动游标
+        int length = segment.reader->documentLength(pivotDoc);
+        double score = 0.0;
+        TermCursor* best = nullptr;
+        double bestScore = -1.0;
+        for (TermCursor* cursor : order) {
+            if (cursor->it.docId() != pivotDoc) {
+                break;
+            }
+            double termScore = bm25.score(cursor->idf, cursor->it.termFrequency(), length);
+            score += termScore;
+            if (termScore > bestScore) {
+                bestScore = termScore;
+                best = cursor;
+            }
+        }
+
+        if (!segment.isDeleted(pivotDoc) && heap.accepts(score)) {
+            heap.push(DocumentNode(segment.docBase + pivotDoc, best->it.positions().first(), score, 1));
+        }
+
+        for (TermCursor* cursor : order) {
+            if (cursor->it.docId() != pivotDoc) {
+                break;
+            }
+            cursor->it.next();
+        }
+    }
+}
+
+QVector<DocumentNode> QueryEngine::searchQuery(const QueryNodePtr& query, int topK) const
+{
+    if (!query) {
+        return QVector<DocumentNode>();
+    }
+    QueryNodePtr expanded = expandFuzzy(expandWildcards(query));
+
+    // idf先全部算好，各段只读；段内仍用自己的副本（隐式共享，不写入时不复制）
+    QHash<QString, double> idfs;
+    collectIdfs(expanded, idfs);
+    return scatterGather([&](const SearchSegment& segment, TopKHeap& heap) {
+        QHash<QString, double> segmentIdfs = idfs;
+        searchQueryInSegment(segment, expanded, segmentIdfs, heap);
+    }, topK);
+}
+
+void QueryEngine::collectIdfs(const QueryNodePtr& node, QHash<QString, double>& idfs) const
+{
+    if (node->type == QueryNode::Term) {
+        cachedIdf(node->term, idfs);
+    }
+    for (const QueryNodePtr& child : node->children) {
+        collectIdfs(child, idfs);
+    }
+}
+
+void QueryEngine::searchQueryInSegment(const SearchSegment& segment, const QueryNodePtr& query,
+                                       QHash<QString, double>& idfs, TopKHeap& heap) const
+{
+    QVector<ScoredTerm> scored;
+    DocIterator* root = buildIterator(segment.reader, query, idfs, scored);
+
+    while (root->next()) {
+        int doc = root->docId();
+        if (segment.isDeleted(doc)) {
+            continue;
+        }
+        int length = segment.reader->documentLength(doc);
+
+        // 匹配时，不在NOT之下且位于当前文档的词都参与打分；
+        // 短语中的词只有短语本身匹配时才位于当前文档
+        double score = 0.0;
+        double bestScore = -1.0;
+        PositionIterator* best = nullptr;
+        for (const ScoredTerm& term : scored) {
+            if (term.it->docId() != doc || term.anchor->docId() != doc) {
+                continue;
+            }
+            double termScore = bm25.score(term.idf, term.it->postings().termFrequency(), length);
+            score += termScore;
+            if (termScore > bestScore) {
+                bestScore = termScore;
+                best = term.anchor;
+            }
+        }
+
+        if (heap.accepts(score)) {
+            if (best) {
+                heap.push(DocumentNode(segment.docBase + doc, best->positions().first(), score, best->width()));
+            } else {
+                heap.push(DocumentNode(segment.docBase + doc, 0, score));
+            }
+        }
+    }
+
+    delete root;
+}
+
+DocIterator* QueryEngine::buildIterator(const IndexReader* reader, const QueryNodePtr& node,
+                                        QHash<QString, double>& idfs, QVector<ScoredTerm>& scored) const
+{
+    switch (node->type) {
+    case QueryNode::Term:
+    case QueryNode::Phrase:
+        return buildPositional(reader, node, idfs, scored);
+
+    case QueryNode::Near: {
+        // 各子节点都是词或短语时才能比较位置，否则退化为AND
+        bool positional = true;
+        for (const QueryNodePtr& child : node->children) {
+            positional = positional && (child->type == QueryNode::Term || child->type == QueryNode::Phrase);
+        }
+        if (!positional) {
+            break;
+        }
+        QVector<PositionIterator*> children;
+        for (const QueryNodePtr& child : node->children) {
+            children.append(buildPositional(reader, child, idfs, scored));
+        }
+        return new NearIterator(children, node->distance);
+    }
+
+    case QueryNode::Or: {
+        // 没有匹配词的通配符扩展为空的OR
+        if (node->children.isEmpty()) {
+            return new TermDocIterator(PostingView());
+        }
+        QVector<DocIterator*> children;
+        for (const QueryNodePtr& child : node->children) {
+            children.append(buildIterator(reader, child, idfs, scored));
+        }
+        return children.size() == 1 ? children.first() : new OrIterator(children);
+    }
+
+    case QueryNode::Not: {
+        // NOT之下的词不参与打分
+        QVector<ScoredTerm> ignored;
+        return new AndNotIterator(new AllDocsIterator(reader->documentCount()),
+                                  buildIterator(reader, node->children.first(), idfs, ignored));
+    }
+
+    case QueryNode::Wildcard:
+        // searchQuery已经把通配符扩展为OR，这里不会出现
+        return new TermDocIterator(PostingView());
+
+    case QueryNode::And:
+        break;
+    }
+
+    // AND（以及无法比较位置的NEAR）：NOT子节点合并为一个排除集合，从正向子节点的交集中减去
+    QVector<DocIterator*> includes;
+    QVector<DocIterator*> excludes;
+    QVector<ScoredTerm> ignored;
+    for (const QueryNodePtr& child : node->children) {
+        if (child->type == QueryNode::Not) {
+            excludes.append(buildIterator(reader, child->children.first(), idfs, ignored));
+        } else {
+            includes.append(buildIterator(reader, child, idfs, scored));
+        }
+    }
+
+    DocIterator* include;
+    if (includes.isEmpty()) {
+        include = new AllDocsIterator(reader->documentCount());
+    } else {
+        include = includes.size() == 1 ? includes.first() : new AndIterator(includes);
+    }
+    if (excludes.isEmpty()) {
+        return include;
+    }
+    return new AndNotIterator(include, excludes.size() == 1 ? excludes.first() : new OrIterator(excludes));
+}
+
+PositionIterator* QueryEngine::buildPositional(const IndexReader* reader, const QueryNodePtr& node,
+                                               QHash<QString, double>& idfs, QVector<ScoredTerm>& scored) const
+{
+    if (node->type == QueryNode::Term) {
+        PostingView postings = reader->postings(node->term);
+        TermDocIterator* it = new TermDocIterator(postings);
+        if (!postings.isEmpty()) {
+            ScoredTerm term = { it, cachedIdf(node->term, idfs) * node->boost, it };
+            scored.append(term);
+        }
+        return it;
+    }
+
+    // 短语：重复出现的词只打一次分
+    QVector<TermDocIterator*> terms;
+    QVector<int> offsets;
+    QVector<ScoredTerm> phraseTerms;
+    QSet<QString> seen;
+    for (const QueryNodePtr& child : node->children) {
+        PostingView postings = reader->postings(child->term);
+        TermDocIterator* it = new TermDocIterator(postings);
+        terms.append(it);
+        offsets.append(child->offset);
+        if (!postings.isEmpty() && !seen.contains(child->term)) {
+            seen.insert(child->term);
+            ScoredTerm term = { it, cachedIdf(child->term, idfs), nullptr };
+            phraseTerms.append(term);
+        }
+    }
+
+    PhraseIterator* phrase = new PhraseIterator(terms, offsets);
+    for (ScoredTerm& term : phraseTerms) {
+        term.anchor = phrase;
+        scored.append(term);
+    }
+    return phrase;
+}
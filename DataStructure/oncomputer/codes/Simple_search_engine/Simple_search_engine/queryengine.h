@@ -0,0 +1,125 @@
+#ifndef QUERYENGINE_H
+#define QUERYENGINE_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "bm25scorer.h"
+#include "dociterator.h"
+#include "indexreader.h"
+#include "invertedindexnode.h"
+#include "queryparser.h"
+#include "resultcache.h"
+#include "topkheap.h"
+
+// 查询引擎：对查询分词后按BM25累加各词得分，逐文档（document-at-a-time）求值，
+// 用WAND跳过不可能进入前k名的文档，结果保存在固定容量的最小堆中。
+// 含有 AND/OR/NOT、短语或NEAR的查询按语法树求出匹配文档，再用其中的正向词打分。
+// 索引可以由多个段组成：idf和平均文档长度按全部段的有效文档统计。段按docId分片，
+// 有效文档达到并行阈值时各段在线程池中并行求值、各自保留前k个结果，再多路归并（scatter-gather）；
+// 否则各段在调用线程中依次求值并共用一个堆。
+// 索引中不存在的查询词（拼写错误）用Levenshtein自动机与词典求交，扩展为编辑距离1-2以内的词，
+// 按距离从小到大、文档频率从高到低最多取MAX_FUZZY_EXPANSIONS个，得分按距离打折后参与排序。
+// 通配符模式用各段的k-gram索引扩展为匹配的词，按文档频率从高到低最多取MAX_WILDCARD_EXPANSIONS个，
+// 与其他词一起OR合并（没有运算符时走WAND）。
+// search的结果按规范化的查询缓存，索引变化（setSegments、updateStatistics）后缓存的结果失效
+class QueryEngine {
+public:
+    static const int DEFAULT_TOP_K = 100;
+    static const int DEFAULT_COMPLETIONS = 10;
+    static const int MAX_FUZZY_EXPANSIONS = 10;
+    static const int MAX_WILDCARD_EXPANSIONS = 64;
+    static const int PARALLEL_MIN_DOCUMENTS = 20000;
+
+    // 通配符扩展的统计：扩展过的模式数、匹配的词数之和、匹配的词超过上限被截断的模式数
+    struct WildcardStats {
+        qint64 patterns = 0;
+        qint64 matchedTerms = 0;
+        qint64 truncatedPatterns = 0;
+    };
+
+    explicit QueryEngine(const IndexReader* reader = nullptr);
+
+    // 切换查询的索引，并重新统计；setReader相当于只有一个段、没有删除文档
+    void setReader(const IndexReader* reader);
+    void setSegments(const QVector<SearchSegment>& segments);
+    const QVector<SearchSegment>& segments() const { return searchSegments; }
+
+    // 索引变化后重新统计有效文档数、平均词数和最短文档词数，缓存的结果随之失效
+    void updateStatistics();
+    quint64 generation() const { return indexGeneration; }
+
+    // 返回得分最高的topK个文档，按得分降序排列；
+    // position和length为得分最高的词（或它所在的短语）在文档中的第一处匹配
+    QVector<DocumentNode> search(const QString& query, int topK = DEFAULT_TOP_K) const;
+    QVector<DocumentNode> searchTerms(const QStringList& terms, int topK = DEFAULT_TOP_K) const;
+    QVector<DocumentNode> searchQuery(const QueryNodePtr& query, int topK = DEFAULT_TOP_K) const;
+
+    // 搜索框自动补全：以prefix开头的索引词，按各段文档频率之和从高到低返回前limit个
+    QStringList complete(const QString& prefix, int limit = DEFAULT_COMPLETIONS) const;
+
+    // 与通配符模式（小写）匹配的索引词，按各段文档频率之和从高到低返回前limit个，
+    // matchCount返回截断前匹配的词数
+    QStringList expandWildcard(const QString& pattern, int limit = MAX_WILDCARD_EXPANSIONS,
+                               int* matchCount = nullptr) const;
+    WildcardStats wildcardStats() const;
+
+    const Bm25Scorer& scorer() const { return bm25; }
+    const ResultCache& resultCache() const { return cache; }
+    void setCacheCapacity(int bytes) { cache.setCapacity(bytes); }
+
+    // 有两个以上的段且有效文档数不少于documents时并行查询各段；0表示总是并行
+    void setParallelThreshold(int documents) { parallelThreshold = documents; }
+    bool isParallel() const;
+
+private:
+    // 参与打分的词：不在NOT之下的Term节点
+    struct ScoredTerm {
+        TermDocIterator* it;
+        double idf;
+        PositionIterator* anchor;   // 结果中显示的匹配：词本身，或它所在的短语
+    };
+
+    // 拼写纠正扩展出的词，boost = 1 - 距离 / 两个词中较短的长度
+    struct FuzzyTerm {
+        QString term;
+        int distance;
+        double boost;
+    };
+
+    typedef std::function<void(const SearchSegment&, TopKHeap&)> SegmentSearch;
+
+    // 用search在各段中求值，返回合并后的前topK个结果
+    QVector<DocumentNode> scatterGather(const SegmentSearch& search, int topK) const;
+    double termIdf(const QString& term) const;   // 按全部段中的文档频率计算
+    QVector<FuzzyTerm> fuzzyExpansions(const QString& term) const;   // 查询词存在或太短时为空
+    QueryNodePtr expandFuzzy(const QueryNodePtr& node) const;
+    QueryNodePtr expandWildcards(const QueryNodePtr& node) const;
+    // 按文档频率从高到低（相同时按词）取前limit个词
+    static QStringList mostFrequent(const QHash<QString, int>& frequencies, int limit);
+    double cachedIdf(const QString& term, QHash<QString, double>& idfs) const;
+    void searchTermsInSegment(const SearchSegment& segment, const QStringList& terms,
+                              const QVector<double>& idfs, TopKHeap& heap) const;
+    void searchQueryInSegment(const SearchSegment& segment, const QueryNodePtr& query,
+                              QHash<QString, double>& idfs, TopKHeap& heap) const;
+    void collectIdfs(const QueryNodePtr& node, QHash<QString, double>& idfs) const;
+    DocIterator* buildIterator(const IndexReader* reader, const QueryNodePtr& node,
+                               QHash<QString, double>& idfs, QVector<ScoredTerm>& scored) const;
+    PositionIterator* buildPositional(const IndexReader* reader, const QueryNodePtr& node,
+                                      QHash<QString, double>& idfs, QVector<ScoredTerm>& scored) const;
+
+    QVector<SearchSegment> searchSegments;
+    Bm25Scorer bm25;
+    quint64 indexGeneration;
+    int liveDocuments;
+    int parallelThreshold;
+    mutable ResultCache cache;
+    mutable std::atomic<qint64> wildcardPatterns;
+    mutable std::atomic<qint64> wildcardMatches;
+    mutable std::atomic<qint64> wildcardTruncated;
+};
+
+#endif // QUERYENGINE_H
@@ -0,0 +1,268 @@
+#include "queryparser.h"
+#include "tokenizer.h"
+#include "wildcard.h"
+
+namespace {
+    // 把多个子节点合并为一个节点，只有一个子节点时直接返回它
+    QueryNodePtr combine(QueryNode::Type type, const QVector<QueryNodePtr>& children)
+    {
+        if (children.isEmpty()) {
+            return QueryNodePtr();
+        }
+        if (children.size() == 1) {
+            return children.first();
+        }
+        QueryNodePtr node(new QueryNode(type));
+        node->children = children;
+        return node;
+    }
+}
+
+QVector<QueryParser::Token> QueryParser::lex(const QString& query)
+{
+    QVector<Token> tokens;
+    QString current;
+    auto flush = [&]() {
+        if (!current.isEmpty()) {
+            tokens.append(Token{ current, false });
+            current.clear();
+        }
+    };
+
+    for (int i = 0; i < query.length(); ++i) {
+        QChar ch = query.at(i);
+        if (ch == '"') {
+            // 引号内的内容整体作为一个短语，缺少右引号时到查询末尾为止
+            flush();
+            int close = query.indexOf('"', i + 1);
+            if (close < 0) {
+                close = query.length();
+            }
+            QString phrase = query.mid(i + 1, close - i - 1).trimmed();
+            if (!phrase.isEmpty()) {
+                tokens.append(Token{ phrase, true });
+            }
+            i = close;
+        } else if (ch.isSpace() || ch == '(' || ch == ')') {
+            flush();
+            if (!ch.isSpace()) {
+                tokens.append(Token{ QString(ch), false });
+            }
+        } else {
+            current.append(ch);
+        }
+    }
+    flush();
+    return tokens;
+}
+
+bool QueryParser::nearDistance(const Token& token, int& distance)
+{
+    if (token.quoted) {
+        return false;
+    }
+    if (token.text == "NEAR") {
+        distance = DEFAULT_NEAR_DISTANCE;
+        return true;
+    }
+    if (token.text.startsWith("NEAR/")) {
+        bool ok = false;
+        int value = token.text.mid(5).toInt(&ok);
+        if (ok && value >= 0) {
+            distance = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool QueryParser::isBooleanQuery(const QString& query)
+{
+    int distance;
+    for (const Token& token : lex(query)) {
+        if (token.quoted || nearDistance(token, distance)) {
+            return true;
+        }
+        if (token.text == "AND" || token.text == "OR" || token.text == "NOT"
+            || token.text == "(" || token.text == ")") {
+            return true;
+        }
+    }
+    return false;
+}
+
+QueryNodePtr QueryParser::parse(const QString& query, QueryNode::Type defaultOperator)
+{
+    QueryParser parser(lex(query), defaultOperator);
+    QueryNodePtr root;
+
+    // 多余的右括号直接忽略，继续解析后面的部分
+    while (!parser.atEnd()) {
+        QueryNodePtr node = parser.parseOr();
+        if (node) {
+            root = root ? combine(defaultOperator, QVector<QueryNodePtr>() << root << node) : node;
+        }
+        if (!parser.atEnd()) {
+            parser.pos++;
+        }
+    }
+    return root;
+}
+
+QueryNodePtr QueryParser::makeWord(const QString& text)
+{
+    // 按索引的分词规则拆开，并记录每个索引词在分词结果中的相对位置。
+    // 中文词组整段出现一次后紧跟着它的各个单字（起始位置相同），词组本身只有整段相同时才能命中，
+    // 这里跳过词组只保留单字，但仍然占一个位置，使相对位置与文档中的一致
+    QVector<::Token> tokens;
+    Tokenizer::tokenize(text, [&tokens](const ::Token& token) { tokens.append(token); });
+
+    QVector<QueryNodePtr> terms;
+    int first = -1;
+    for (int i = 0; i < tokens.size(); ++i) {
+        if (tokens[i].kind == ::Token::ChineseRun) {
+            continue;
+        }
+        if (first < 0) {
+            first = i;
+        }
+        terms.append(QueryNodePtr(new QueryNode(QueryNode::Term, Tokenizer::termText(text, tokens[i]), i - first)));
+    }
+
+    return combine(QueryNode::Phrase, terms);
+}
+
+QueryNodePtr QueryParser::makeWildcard(const QString& text)
+{
+    // 索引词为小写；只有通配符的模式会匹配整个词典，忽略
+    QString pattern = text.toLower();
+    if (Wildcard::literalLength(pattern) == 0) {
+        return QueryNodePtr();
+    }
+    return QueryNodePtr(new QueryNode(QueryNode::Wildcard, pattern));
+}
+
+bool QueryParser::isKeyword(const char* keyword) const
+{
+    return !atEnd() && !tokens[pos].quoted && tokens[pos].text == keyword;
+}
+
+bool QueryParser::isOperator() const
+{
+    int distance;
+    return isKeyword("AND") || isKeyword("OR") || isKeyword("NOT")
+           || (!atEnd() && nearDistance(tokens[pos], distance));
+}
+
+QueryNodePtr QueryParser::parseOr()
+{
+    QVector<QueryNodePtr> children;
+    while (!atEnd() && !isKeyword(")")) {
+        if (isKeyword("OR")) {
+            pos++;
+            continue;
+        }
+        QueryNodePtr node = parseAnd();
+        if (node) {
+            children.append(node);
+        }
+    }
+    return combine(QueryNode::Or, children);
+}
+
+QueryNodePtr QueryParser::parseAnd()
+{
+    // joined表示下一个操作数属于当前的AND：显式AND之后，或默认运算符为AND时
+    QVector<QueryNodePtr> children;
+    bool joined = true;
+    while (!atEnd() && !isKeyword(")") && !isKeyword("OR")) {
+        if (isKeyword("AND")) {
+            pos++;
+            joined = true;
+            continue;
+        }
+        if (!joined) {
+            break;
+        }
+        QueryNodePtr node = parseNot();
+        if (node) {
+            children.append(node);
+        }
+        joined = defaultOperator == QueryNode::And;
+    }
+    return combine(QueryNode::And, children);
+}
+
+QueryNodePtr QueryParser::parseNot()
+{
+    if (isKeyword("NOT")) {
+        pos++;
+        if (atEnd() || isKeyword(")") || isKeyword("AND") || isKeyword("OR")) {
+            return QueryNodePtr();
+        }
+        QueryNodePtr child = parseNot();
+        if (!child) {
+            return QueryNodePtr();
+        }
+        QueryNodePtr node(new QueryNode(QueryNode::Not));
+        node->children.append(child);
+        return node;
+    }
+    return parseNear();
+}
+
+QueryNodePtr QueryParser::parseNear()
+{
+    QueryNodePtr first = parsePrimary();
+    int distance;
+    if (atEnd() || !nearDistance(tokens[pos], distance)) {
+        return first;
+    }
+
+    QVector<QueryNodePtr> children;
+    if (first) {
+        children.append(first);
+    }
+    int maxDistance = 0;
+    while (!atEnd() && nearDistance(tokens[pos], distance)) {
+        pos++;
+        maxDistance = qMax(maxDistance, distance);
+        if (atEnd() || isKeyword(")") || isOperator()) {
+            break;
+        }
+        QueryNodePtr node = parsePrimary();
+        if (node) {
+            children.append(node);
+        }
+    }
+
+    // 缺少一侧时相当于普通的词
+    if (children.size() < 2) {
+        return combine(QueryNode::And, children);
+    }
+    QueryNodePtr node(new QueryNode(QueryNode::Near));
+    node->distance = maxDistance;
+    node->children = children;
+    return node;
+}
+
+QueryNodePtr QueryParser::parsePrimary()
+{
+    if (isKeyword("(")) {
+        pos++;
+        QueryNodePtr node = parseOr();
+        if (isKeyword(")")) {
+            pos++;
+        }
+        return node;
+    }
+    if (isOperator()) {
+        pos++;
+        return QueryNodePtr();
+    }
+    const Token& token = tokens[pos++];
+    if (!token.quoted && Wildcard::isPattern(token.text)) {
+        return makeWildcard(token.text);
+    }
+    return makeWord(token.text);
+}
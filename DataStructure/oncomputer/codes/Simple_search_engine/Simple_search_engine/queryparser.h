@@ -0,0 +1,72 @@
+#ifndef QUERYPARSER_H
+#define QUERYPARSER_H
+
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 查询语法树的节点
+struct QueryNode {
+    enum Type { Term, Phrase, Near, And, Or, Not, Wildcard };
+
+    Type type;
+    QString term;                                   // Term节点对应的索引词，Wildcard节点为通配符模式
+    int offset;                                     // Term节点在短语中相对第一个词的位置
+    int distance;                                   // Near节点允许的最大间隔词数
+    double boost;                                   // Term节点得分的权重，拼写纠正扩展出的词小于1
+    QVector<QSharedPointer<QueryNode>> children;
+
+    explicit QueryNode(Type t, const QString& w = QString(), int o = 0)
+        : type(t), term(w), offset(o), distance(0), boost(1.0) {}
+};
+
+typedef QSharedPointer<QueryNode> QueryNodePtr;
+
+// 查询解析器
+//   语法: 词之间用 AND、OR、NOT 连接，可以用括号分组；优先级 NEAR > NOT > AND > OR
+//         "..."     引号内的内容作为短语，必须按顺序连续出现
+//         a NEAR/k b 两边在文档中相隔不超过k个词，省略/k时k为DEFAULT_NEAR_DISTANCE；
+//                   连续的NEAR合并为一个节点，距离取其中最大的k
+//   每个词按索引的分词规则拆开，拆出多个索引词时（中文、带连字符的英文等）作为短语匹配；
+//   含有*或?的词（不在引号内）作为通配符模式，不分词，由查询引擎扩展为匹配的索引词
+class QueryParser {
+public:
+    static const int DEFAULT_NEAR_DISTANCE = 10;
+
+    // 是否包含布尔运算符、括号、引号或NEAR
+    static bool isBooleanQuery(const QString& query);
+
+    // 查询为空时返回空指针；defaultOperator为相邻两个词之间省略运算符时的连接方式
+    static QueryNodePtr parse(const QString& query, QueryNode::Type defaultOperator = QueryNode::And);
+
+private:
+    struct Token {
+        QString text;
+        bool quoted;
+    };
+
+    QueryParser(const QVector<Token>& tokens, QueryNode::Type defaultOperator)
+        : tokens(tokens), pos(0), defaultOperator(defaultOperator) {}
+
+    static QVector<Token> lex(const QString& query);
+    static bool nearDistance(const Token& token, int& distance);
+    static QueryNodePtr makeWord(const QString& text);
+    static QueryNodePtr makeWildcard(const QString& text);
+
+    QueryNodePtr parseOr();
+    QueryNodePtr parseAnd();
+    QueryNodePtr parseNot();
+    QueryNodePtr parseNear();
+    QueryNodePtr parsePrimary();
+
+    bool atEnd() const { return pos >= tokens.size(); }
+    bool isKeyword(const char* keyword) const;
+    bool isOperator() const;
+
+    QVector<Token> tokens;
+    int pos;
+    QueryNode::Type defaultOperator;
+};
+
+#endif // QUERYPARSER_H
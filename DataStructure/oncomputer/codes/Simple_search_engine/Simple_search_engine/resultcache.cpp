@@ -0,0 +1,83 @@
+#include "resultcache.h"
+#include <QMutexLocker>
+
+ResultCache::ResultCache(int capacity)
+    : entries(capacity), hitCount(0), missCount(0)
+{
+}
+
+int ResultCache::costOf(const QString& key, const QVector<DocumentNode>& results)
+{
+    // 键和结果数组的大小，加上QCache节点和Entry的固定开销
+    return static_cast<int>(key.size() * sizeof(QChar) + results.size() * sizeof(DocumentNode)
+                            + sizeof(Entry) + 64);
+}
+
+bool ResultCache::find(const QString& key, quint64 generation, QVector<DocumentNode>& results)
+{
+    QMutexLocker locker(&mutex);
+    Entry* entry = entries.object(key);
+    if (entry && entry->generation != generation) {
+        entries.remove(key);
+        entry = nullptr;
+    }
+    if (!entry) {
+        missCount++;
+        return false;
+    }
+    hitCount++;
+    results = entry->results;
+    return true;
+}
+
+void ResultCache::insert(const QString& key, quint64 generation, const QVector<DocumentNode>& results)
+{
+    Entry* entry = new Entry;
+    entry->generation = generation;
+    entry->results = results;
+
+    QMutexLocker locker(&mutex);
+    entries.insert(key, entry, costOf(key, results));
+}
+
+void ResultCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    entries.clear();
+}
+
+void ResultCache::setCapacity(int capacity)
+{
+    QMutexLocker locker(&mutex);
+    entries.setMaxCost(capacity);
+}
+
+int ResultCache::capacity() const
+{
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(entries.maxCost());
+}
+
+int ResultCache::memoryUsage() const
+{
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(entries.totalCost());
+}
+
+int ResultCache::size() const
+{
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(entries.size());
+}
+
+qint64 ResultCache::hits() const
+{
+    QMutexLocker locker(&mutex);
+    return hitCount;
+}
+
+qint64 ResultCache::misses() const
+{
+    QMutexLocker locker(&mutex);
+    return missCount;
+}
@@ -0,0 +1,46 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QCache>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include "invertedindexnode.h"
+
+// 查询结果缓存：键为规范化的查询，值为前k名文档的docId、得分和匹配位置。
+// 用QCache按占用的字节数淘汰最久没有用到的结果；
+// 每个结果记下存入时索引的代数，索引变化后代数增加，旧的结果在查找时当作未命中并删除。
+// 线程安全
+class ResultCache {
+public:
+    static const int DEFAULT_CAPACITY = 4 * 1024 * 1024;   // 字节
+
+    explicit ResultCache(int capacity = DEFAULT_CAPACITY);
+
+    // 找到generation代的结果时返回true
+    bool find(const QString& key, quint64 generation, QVector<DocumentNode>& results);
+    void insert(const QString& key, quint64 generation, const QVector<DocumentNode>& results);
+    void clear();
+
+    void setCapacity(int capacity);
+    int capacity() const;
+    int memoryUsage() const;
+    int size() const;
+    qint64 hits() const;
+    qint64 misses() const;
+
+private:
+    struct Entry {
+        quint64 generation;
+        QVector<DocumentNode> results;
+    };
+
+    static int costOf(const QString& key, const QVector<DocumentNode>& results);
+
+    mutable QMutex mutex;
+    QCache<QString, Entry> entries;
+    qint64 hitCount;
+    qint64 missCount;
+};
+
+#endif // RESULTCACHE_H
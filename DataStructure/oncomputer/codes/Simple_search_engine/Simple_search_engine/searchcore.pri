@@ -0,0 +1,18 @@
+# 链接搜索引擎核心静态库（searchcore/searchcore.pro）。
+# 核心库由上一级目录的 Simple_search_engine.pro 先于各程序编译，
+# 各程序的编译目录与源目录结构相同，按相对位置找到核心库的编译目录。
+# 单独打开某个程序的工程时没有核心库的编译目录，改为把核心源文件直接编进程序
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+SEARCHCORE_BUILD = $$OUT_PWD/$$relative_path($$PWD, $$_PRO_FILE_PWD_)/searchcore
+SEARCHCORE_OUT = $$SEARCHCORE_BUILD
+win32:CONFIG(debug, debug|release): SEARCHCORE_OUT = $$SEARCHCORE_OUT/debug
+else:win32:CONFIG(release, debug|release): SEARCHCORE_OUT = $$SEARCHCORE_OUT/release
+
+exists($$SEARCHCORE_BUILD/Makefile) {
+    LIBS += -L$$SEARCHCORE_OUT -lsearchcore
+    win32-msvc*: PRE_TARGETDEPS += $$SEARCHCORE_OUT/searchcore.lib
+    else: PRE_TARGETDEPS += $$SEARCHCORE_OUT/libsearchcore.a
+} else {
+    include(searchcore/sources.pri)
+}
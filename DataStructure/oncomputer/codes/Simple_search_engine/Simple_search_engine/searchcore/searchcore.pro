@@ -0,0 +1,10 @@
+# 搜索引擎核心代码（分词、建索引、段文件、查询），不依赖界面，编译为静态库，
+# 由主程序、基准测试和压力测试程序链接（见 ../searchcore.pri）
+
+TEMPLATE = lib
+CONFIG += staticlib c++17
+QT = core core5compat concurrent
+
+TARGET = searchcore
+
+include(sources.pri)
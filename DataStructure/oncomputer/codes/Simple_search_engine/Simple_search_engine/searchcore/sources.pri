@@ -0,0 +1,55 @@
+# 核心库的源文件列表，由 searchcore.pro 编译为静态库；
+# 单独打开某个程序的工程、没有核心库可链接时，由 ../searchcore.pri 直接编进程序
+
+# 源文件与主程序放在同一个目录中
+SEARCHCORE_DIR = $$PWD/..
+INCLUDEPATH += $$SEARCHCORE_DIR
+
+SOURCES += \
+    $$SEARCHCORE_DIR/dociterator.cpp \
+    $$SEARCHCORE_DIR/documentreader.cpp \
+    $$SEARCHCORE_DIR/incrementalindex.cpp \
+    $$SEARCHCORE_DIR/indexbuilder.cpp \
+    $$SEARCHCORE_DIR/indexreader.cpp \
+    $$SEARCHCORE_DIR/ingestpipeline.cpp \
+    $$SEARCHCORE_DIR/kgramindex.cpp \
+    $$SEARCHCORE_DIR/levenshteinautomaton.cpp \
+    $$SEARCHCORE_DIR/postinglist.cpp \
+    $$SEARCHCORE_DIR/queryengine.cpp \
+    $$SEARCHCORE_DIR/queryparser.cpp \
+    $$SEARCHCORE_DIR/resultcache.cpp \
+    $$SEARCHCORE_DIR/segment.cpp \
+    $$SEARCHCORE_DIR/segmentmerger.cpp \
+    $$SEARCHCORE_DIR/skiplist.cpp \
+    $$SEARCHCORE_DIR/snippetbuilder.cpp \
+    $$SEARCHCORE_DIR/termdictionary.cpp \
+    $$SEARCHCORE_DIR/termtrie.cpp \
+    $$SEARCHCORE_DIR/tokenizer.cpp \
+    $$SEARCHCORE_DIR/tokenoffsettable.cpp \
+    $$SEARCHCORE_DIR/wildcard.cpp
+
+HEADERS += \
+    $$SEARCHCORE_DIR/bm25scorer.h \
+    $$SEARCHCORE_DIR/dociterator.h \
+    $$SEARCHCORE_DIR/documentreader.h \
+    $$SEARCHCORE_DIR/incrementalindex.h \
+    $$SEARCHCORE_DIR/indexbuilder.h \
+    $$SEARCHCORE_DIR/indexreader.h \
+    $$SEARCHCORE_DIR/ingestpipeline.h \
+    $$SEARCHCORE_DIR/invertedindexnode.h \
+    $$SEARCHCORE_DIR/kgramindex.h \
+    $$SEARCHCORE_DIR/levenshteinautomaton.h \
+    $$SEARCHCORE_DIR/postinglist.h \
+    $$SEARCHCORE_DIR/queryengine.h \
+    $$SEARCHCORE_DIR/queryparser.h \
+    $$SEARCHCORE_DIR/resultcache.h \
+    $$SEARCHCORE_DIR/segment.h \
+    $$SEARCHCORE_DIR/segmentmerger.h \
+    $$SEARCHCORE_DIR/skiplist.h \
+    $$SEARCHCORE_DIR/snippetbuilder.h \
+    $$SEARCHCORE_DIR/termdictionary.h \
+    $$SEARCHCORE_DIR/termtrie.h \
+    $$SEARCHCORE_DIR/tokenizer.h \
+    $$SEARCHCORE_DIR/tokenoffsettable.h \
+    $$SEARCHCORE_DIR/topkheap.h \
+    $$SEARCHCORE_DIR/wildcard.h
@@ -0,0 +1,540 @@
+#include "segment.h"
+#include "wildcard.h"
+#include <QSaveFile>
+#include <cstring>
+
+// 文件头
+struct Segment::Header {
+    char magic[8];
+    quint32 version;
+    quint32 documentCount;
+    quint32 termCount;
+    quint32 trieUnitCount;      // 字典树的单元数，0表示没有字典树
+    quint64 documentTableOffset;
+    quint64 termTableOffset;
+    quint64 dataOffset;
+    quint64 fileSize;
+    // 以下为版本2新增：字典树的单元数组，后面紧跟字符编号表的页索引和triePageCount页编号
+    quint64 trieOffset;
+    quint32 triePageCount;
+    quint32 reserved;
+    // 以下为版本3新增：k-gram表、(kgramCount + 1)个列表偏移和列表数据，共kgramBytes字节
+    quint64 kgramOffset;
+    quint32 kgramCount;
+    quint32 kgramBytes;
+};
+
+// 文档表中的一项
+struct Segment::DocumentEntry {
+    quint64 pathOffset;         // 路径在文件中的偏移（UTF-16）
+    quint32 pathLength;         // 路径的字符数
+    quint32 tokenCount;         // 文档的词数，也是词位置表中的词数
+    quint64 offsetsOffset;      // 词位置表：checkpointCount个int，后面紧跟offsetsBytes字节
+    quint32 offsetsBytes;
+    quint32 checkpointCount;
+};
+
+// 词典中的一项
+struct Segment::TermEntry {
+    quint64 termOffset;         // 词在文件中的偏移（UTF-16）
+    quint32 termLength;         // 词的字符数
+    quint32 documentFrequency;
+    quint64 postingsOffset;     // 压缩倒排表的偏移
+    quint32 postingsSize;
+    quint32 maxTermFrequency;
+};
+
+namespace {
+    const char SEGMENT_MAGIC[8] = { 'S', 'S', 'E', 'S', 'E', 'G', '0', '1' };
+    const qint64 HEADER_SIZE_V1 = 56;       // 版本1的文件头到fileSize为止
+    const qint64 HEADER_SIZE_V2 = 72;       // 版本2的文件头到reserved为止
+
+    quint64 alignedTo8(quint64 offset)
+    {
+        return (offset + 7) / 8 * 8;
+    }
+
+    quint64 trieBytes(const TermTrieView& trie)
+    {
+        if (trie.isEmpty()) {
+            return 0;
+        }
+        return quint64(trie.size) * sizeof(TrieUnit)
+               + quint64(TermTrieView::PAGE_COUNT + trie.codePageCount * TermTrieView::PAGE_SIZE) * sizeof(quint16);
+    }
+
+    void alignTo(QByteArray& bytes, int alignment)
+    {
+        while (bytes.size() % alignment != 0) {
+            bytes.append('\0');
+        }
+    }
+
+    void appendRaw(QByteArray& bytes, const void* data, qint64 size)
+    {
+        bytes.append(static_cast<const char*>(data), size);
+    }
+
+    // 按UTF-16码元比较，与QString的operator<顺序一致
+    int compareTerm(const QChar* data, int length, const QString& term)
+    {
+        int n = qMin(length, static_cast<int>(term.length()));
+        for (int i = 0; i < n; ++i) {
+            ushort a = data[i].unicode();
+            ushort b = term.at(i).unicode();
+            if (a != b) {
+                return a < b ? -1 : 1;
+            }
+        }
+        return length == term.length() ? 0 : (length < term.length() ? -1 : 1);
+    }
+}
+
+Segment::Segment()
+    : base(nullptr), mappedSize(0)
+{
+}
+
+Segment::~Segment()
+{
+    close();
+}
+
+bool Segment::write(const QString& filePath, const IndexReader& index, QString* errorMessage)
+{
+    int documentCount = index.documentCount();
+    int termCount = index.termCount();
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.documentCount = documentCount;
+    header.documentTableOffset = sizeof(Header);
+    header.termTableOffset = header.documentTableOffset + quint64(documentCount) * sizeof(DocumentEntry);
+
+    // 数据区的偏移要等词典写完才知道，先把数据写进独立的缓冲区，最后再加上数据区起点
+    QVector<DocumentEntry> documentTable(documentCount);
+    QVector<TermEntry> termTable;
+    termTable.reserve(termCount);
+    QVector<QString> termList;
+    termList.reserve(termCount);
+    QByteArray data;
+
+    for (int docId = 0; docId < documentCount; ++docId) {
+        DocumentEntry& entry = documentTable[docId];
+        QString path = index.documentPath(docId);
+        TokenOffsetView offsets = index.tokenOffsets(docId);
+
+        alignTo(data, 8);
+        entry.pathOffset = data.size();
+        entry.pathLength = path.length();
+        appendRaw(data, path.constData(), path.length() * sizeof(QChar));
+
+        alignTo(data, 8);
+        entry.tokenCount = index.documentLength(docId);
+        entry.offsetsOffset = data.size();
+        entry.checkpointCount = offsets.checkpointCount;
+        entry.offsetsBytes = offsets.byteCount;
+        appendRaw(data, offsets.checkpoints, offsets.checkpointCount * sizeof(int));
+        appendRaw(data, offsets.bytes, offsets.byteCount);
+    }
+
+    index.forEachTerm([&](const QString& term, const PostingView& postings) {
+        TermEntry entry;
+        alignTo(data, 2);
+        entry.termOffset = data.size();
+        entry.termLength = term.length();
+        appendRaw(data, term.constData(), term.length() * sizeof(QChar));
+
+        entry.postingsOffset = data.size();
+        entry.postingsSize = postings.size;
+        entry.documentFrequency = postings.documentFrequency;
+        entry.maxTermFrequency = postings.maxTermFrequency;
+        appendRaw(data, postings.data, postings.size);
+
+        termTable.append(entry);
+        termList.append(term);
+    });
+
+    // 词典写完后建立字典树和k-gram索引，依次放在词典和数据区之间
+    TermTrie trie;
+    trie.build(termList);
+    TermTrieView trieView = trie.view();
+    KGramIndex kgramIndex;
+    kgramIndex.build(termList);
+    KGramIndexView kgramView = kgramIndex.view();
+
+    header.termCount = termTable.size();
+    header.trieOffset = alignedTo8(header.termTableOffset + quint64(termTable.size()) * sizeof(TermEntry));
+    header.trieUnitCount = trieView.size;
+    header.triePageCount = trieView.codePageCount;
+    header.kgramOffset = alignedTo8(header.trieOffset + trieBytes(trieView));
+    header.kgramCount = kgramView.gramCount;
+    header.kgramBytes = kgramView.byteCount();
+    header.dataOffset = alignedTo8(header.kgramOffset + header.kgramBytes);
+    header.fileSize = header.dataOffset + data.size();
+
+    for (DocumentEntry& entry : documentTable) {
+        entry.pathOffset += header.dataOffset;
+        entry.offsetsOffset += header.dataOffset;
+    }
+    for (TermEntry& entry : termTable) {
+        entry.termOffset += header.dataOffset;
+        entry.postingsOffset += header.dataOffset;
+    }
+
+    QByteArray head;
+    appendRaw(head, &header, sizeof(header));
+    appendRaw(head, documentTable.constData(), documentTable.size() * sizeof(DocumentEntry));
+    appendRaw(head, termTable.constData(), termTable.size() * sizeof(TermEntry));
+    alignTo(head, 8);
+    if (!trieView.isEmpty()) {
+        appendRaw(head, trieView.units, trieView.size * sizeof(TrieUnit));
+        appendRaw(head, trieView.pages, TermTrieView::PAGE_COUNT * sizeof(quint16));
+        appendRaw(head, trieView.codes, trieView.codePageCount * TermTrieView::PAGE_SIZE * sizeof(quint16));
+        alignTo(head, 8);
+    }
+    if (!kgramView.isEmpty()) {
+        appendRaw(head, kgramView.grams, kgramView.gramCount * sizeof(quint32));
+        appendRaw(head, kgramView.offsets, (kgramView.gramCount + 1) * sizeof(quint32));
+        appendRaw(head, kgramView.data, kgramView.offsets[kgramView.gramCount]);
+        alignTo(head, 8);
+    }
+
+    QSaveFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法写入索引文件 %1: %2").arg(filePath, out.errorString());
+        }
+        return false;
+    }
+    if (out.write(head) != head.size() || out.write(data) != data.size() || !out.commit()) {
+        if (errorMessage) {
+            *errorMessage = QString("写入索引文件失败 %1: %2").arg(filePath, out.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool Segment::open(const QString& filePath, QString* errorMessage)
+{
+    close();
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法打开索引文件 %1: %2").arg(filePath, file.errorString());
+        }
+        return false;
+    }
+
+    mappedSize = file.size();
+    base = mappedSize >= HEADER_SIZE_V1 ? file.map(0, mappedSize) : nullptr;
+    if (!base) {
+        if (errorMessage) {
+            *errorMessage = QString("无法映射索引文件 %1").arg(filePath);
+        }
+        close();
+        return false;
+    }
+
+    if (!validate(errorMessage)) {
+        close();
+        return false;
+    }
+
+    const Header* h = header();
+    if (h->version >= 2 && h->trieUnitCount > 0) {
+        trie.units = reinterpret_cast<const TrieUnit*>(base + h->trieOffset);
+        trie.size = h->trieUnitCount;
+        trie.pages = reinterpret_cast<const quint16*>(trie.units + trie.size);
+        trie.codes = trie.pages + TermTrieView::PAGE_COUNT;
+        trie.codePageCount = h->triePageCount;
+    }
+    if (h->version >= 3 && h->kgramCount > 0) {
+        kgrams.grams = reinterpret_cast<const quint32*>(base + h->kgramOffset);
+        kgrams.gramCount = h->kgramCount;
+        kgrams.offsets = kgrams.grams + kgrams.gramCount;
+        kgrams.data = reinterpret_cast<const uchar*>(kgrams.offsets + kgrams.gramCount + 1);
+    }
+    return true;
+}
+
+void Segment::close()
+{
+    if (base) {
+        file.unmap(base);
+        base = nullptr;
+    }
+    trie = TermTrieView();
+    kgrams = KGramIndexView();
+    if (file.isOpen()) {
+        file.close();
+    }
+    mappedSize = 0;
+}
+
+bool Segment::validate(QString* errorMessage) const
+{
+    // 打开时检查一次所有偏移，之后查询不再做边界检查
+    auto fail = [&](const QString& reason) {
+        if (errorMessage) {
+            *errorMessage = QString("索引文件已损坏: %1").arg(reason);
+        }
+        return false;
+    };
+    auto inRange = [&](quint64 offset, quint64 size) {
+        return offset <= quint64(mappedSize) && size <= quint64(mappedSize) - offset;
+    };
+
+    const Header* h = header();
+    if (std::memcmp(h->magic, SEGMENT_MAGIC, sizeof(h->magic)) != 0) {
+        return fail("文件标识不匹配");
+    }
+    if (h->version < 1 || h->version > VERSION) {
+        return fail(QString("不支持的版本 %1").arg(h->version));
+    }
+    if ((h->version == 2 && mappedSize < HEADER_SIZE_V2) || (h->version >= 3 && mappedSize < qint64(sizeof(Header)))) {
+        return fail("文件头不完整");
+    }
+    if (h->fileSize != quint64(mappedSize)) {
+        return fail("文件大小不匹配");
+    }
+    if (h->documentTableOffset % 8 != 0 || h->termTableOffset % 8 != 0
+        || !inRange(h->documentTableOffset, quint64(h->documentCount) * sizeof(DocumentEntry))
+        || !inRange(h->termTableOffset, quint64(h->termCount) * sizeof(TermEntry))) {
+        return fail("表的位置越界");
+    }
+
+    const DocumentEntry* docs = documents();
+    for (quint32 i = 0; i < h->documentCount; ++i) {
+        const DocumentEntry& entry = docs[i];
+        int expectedCheckpoints = (entry.tokenCount + TokenOffsetTable::CHECKPOINT_INTERVAL - 1)
+                                  / TokenOffsetTable::CHECKPOINT_INTERVAL;
+        if (entry.pathOffset % 2 != 0 || !inRange(entry.pathOffset, quint64(entry.pathLength) * sizeof(QChar))
+            || entry.offsetsOffset % sizeof(int) != 0 || int(entry.checkpointCount) != expectedCheckpoints
+            || !inRange(entry.offsetsOffset, quint64(entry.checkpointCount) * sizeof(int) + entry.offsetsBytes)) {
+            return fail(QString("文档 %1 的数据越界").arg(i));
+        }
+    }
+
+    const TermEntry* entries = terms();
+    for (quint32 i = 0; i < h->termCount; ++i) {
+        const TermEntry& entry = entries[i];
+        if (entry.termOffset % 2 != 0 || !inRange(entry.termOffset, quint64(entry.termLength) * sizeof(QChar))
+            || !inRange(entry.postingsOffset, entry.postingsSize)) {
+            return fail(QString("词 %1 的数据越界").arg(i));
+        }
+    }
+
+    // 字典树：叶子中的序号不能超出词典，字符编号表的页号不能超出页数
+    if (h->version >= 2 && h->trieUnitCount > 0) {
+        TermTrieView view;
+        view.size = h->trieUnitCount;
+        view.codePageCount = h->triePageCount;
+        if (h->trieOffset % 8 != 0 || h->triePageCount > quint32(TermTrieView::PAGE_COUNT)
+            || !inRange(h->trieOffset, trieBytes(view))) {
+            return fail("字典树的位置越界");
+        }
+        const TrieUnit* units = reinterpret_cast<const TrieUnit*>(base + h->trieOffset);
+        for (quint32 i = 0; i < h->trieUnitCount; ++i) {
+            if (units[i].check >= 0 && units[i].base < 0 && quint32(-(units[i].base + 1)) >= h->termCount) {
+                return fail(QString("字典树节点 %1 越界").arg(i));
+            }
+        }
+        const quint16* pages = reinterpret_cast<const quint16*>(units + h->trieUnitCount);
+        for (int i = 0; i < TermTrieView::PAGE_COUNT; ++i) {
+            if (pages[i] > h->triePageCount) {
+                return fail("字符编号表越界");
+            }
+        }
+    }
+
+    // k-gram索引：列表偏移不减且不超出数据，列表中的序号在解码时不检查，查询时按序号访问词典前要确认
+    if (h->version >= 3 && h->kgramCount > 0) {
+        quint64 tableBytes = quint64(h->kgramCount) * sizeof(quint32) * 2 + sizeof(quint32);
+        if (h->kgramOffset % 8 != 0 || tableBytes > h->kgramBytes || !inRange(h->kgramOffset, h->kgramBytes)) {
+            return fail("k-gram索引的位置越界");
+        }
+        const quint32* offsets = reinterpret_cast<const quint32*>(base + h->kgramOffset) + h->kgramCount;
+        for (quint32 i = 0; i < h->kgramCount; ++i) {
+            if (offsets[i] > offsets[i + 1]) {
+                return fail("k-gram列表越界");
+            }
+        }
+        if (offsets[0] != 0 || tableBytes + offsets[h->kgramCount] != h->kgramBytes) {
+            return fail("k-gram列表越界");
+        }
+    }
+    return true;
+}
+
+const Segment::Header* Segment::header() const
+{
+    return reinterpret_cast<const Header*>(base);
+}
+
+const Segment::DocumentEntry* Segment::documents() const
+{
+    return reinterpret_cast<const DocumentEntry*>(base + header()->documentTableOffset);
+}
+
+const Segment::TermEntry* Segment::terms() const
+{
+    return reinterpret_cast<const TermEntry*>(base + header()->termTableOffset);
+}
+
+QString Segment::stringAt(quint64 offset, quint32 length) const
+{
+    return QString(reinterpret_cast<const QChar*>(base + offset), length);
+}
+
+PostingView Segment::postingsOf(const TermEntry& entry) const
+{
+    PostingView view;
+    view.data = reinterpret_cast<const char*>(base + entry.postingsOffset);
+    view.size = entry.postingsSize;
+    view.documentFrequency = entry.documentFrequency;
+    view.maxTermFrequency = entry.maxTermFrequency;
+    return view;
+}
+
+int Segment::documentCount() const
+{
+    return base ? header()->documentCount : 0;
+}
+
+int Segment::documentLength(int docId) const
+{
+    return documents()[docId].tokenCount;
+}
+
+QString Segment::documentPath(int docId) const
+{
+    const DocumentEntry& entry = documents()[docId];
+    return stringAt(entry.pathOffset, entry.pathLength);
+}
+
+TokenOffsetView Segment::tokenOffsets(int docId) const
+{
+    const DocumentEntry& entry = documents()[docId];
+    TokenOffsetView view;
+    view.checkpoints = reinterpret_cast<const int*>(base + entry.offsetsOffset);
+    view.checkpointCount = entry.checkpointCount;
+    view.bytes = reinterpret_cast<const char*>(view.checkpoints + entry.checkpointCount);
+    view.byteCount = entry.offsetsBytes;
+    view.count = entry.tokenCount;
+    return view;
+}
+
+PostingView Segment::postings(const QString& term) const
+{
+    int index = base ? findTerm(term) : -1;
+    return index >= 0 ? postingsAt(index) : PostingView();
+}
+
+int Segment::termCount() const
+{
+    return base ? header()->termCount : 0;
+}
+
+void Segment::forEachTerm(const TermVisitor& visitor) const
+{
+    for (int i = 0; i < termCount(); ++i) {
+        visitor(termAt(i), postingsAt(i));
+    }
+}
+
+void Segment::forEachTermWithPrefix(const QString& prefix, const TermVisitor& visitor) const
+{
+    // 以prefix开头的词在词典中连续排列
+    const TermEntry* entries = terms();
+    for (int i = lowerBound(prefix); i < termCount(); ++i) {
+        const TermEntry& entry = entries[i];
+        if (int(entry.termLength) < prefix.length()
+            || compareTerm(reinterpret_cast<const QChar*>(base + entry.termOffset), prefix.length(), prefix) != 0) {
+            break;
+        }
+        visitor(termAt(i), postingsOf(entry));
+    }
+}
+
+QString Segment::ceilingTerm(const QString& term) const
+{
+    int index = lowerBound(term);
+    return index < termCount() ? termAt(index) : QString();
+}
+
+void Segment::forEachWildcardTerm(const QString& pattern, const TermVisitor& visitor) const
+{
+    // 只有末尾一个*时前缀范围就是结果；否则k-gram求交得到候选词，模式中没有k-gram时退回前缀范围
+    QVector<int> candidates;
+    if (kgrams.isEmpty() || Wildcard::isPrefixPattern(pattern) || !kgrams.candidates(pattern, candidates)) {
+        IndexReader::forEachWildcardTerm(pattern, visitor);
+        return;
+    }
+    for (int index : candidates) {
+        if (index >= termCount()) {
+            break;
+        }
+        QString term = termAt(index);
+        if (Wildcard::matches(pattern, term)) {
+            visitor(term, postingsAt(index));
+        }
+    }
+}
+
+QString Segment::termAt(int index) const
+{
+    const TermEntry& entry = terms()[index];
+    return stringAt(entry.termOffset, entry.termLength);
+}
+
+PostingView Segment::postingsAt(int index) const
+{
+    return postingsOf(terms()[index]);
+}
+
+int Segment::findTerm(const QString& term) const
+{
+    const TermEntry* entries = terms();
+    if (!trie.isEmpty()) {
+        // 字典树只比较到叶子为止，再与词典中的词比较一次
+        int index = trie.find(term);
+        if (index < 0) {
+            return -1;
+        }
+        const TermEntry& entry = entries[index];
+        return compareTerm(reinterpret_cast<const QChar*>(base + entry.termOffset), entry.termLength, term) == 0
+                   ? index : -1;
+    }
+
+    int index = lowerBound(term);
+    if (index < termCount()) {
+        const TermEntry& entry = entries[index];
+        if (compareTerm(reinterpret_cast<const QChar*>(base + entry.termOffset), entry.termLength, term) == 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+int Segment::lowerBound(const QString& term) const
+{
+    // 词典按词升序排列，二分查找
+    const TermEntry* entries = terms();
+    int low = 0;
+    int high = termCount();
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        const TermEntry& entry = entries[mid];
+        if (compareTerm(reinterpret_cast<const QChar*>(base + entry.termOffset), entry.termLength, term) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
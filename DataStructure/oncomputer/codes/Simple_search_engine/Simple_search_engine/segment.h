@@ -0,0 +1,73 @@
+#ifndef SEGMENT_H
+#define SEGMENT_H
+
+#include <QFile>
+#include <QString>
+#include "indexreader.h"
+#include "kgramindex.h"
+#include "termtrie.h"
+
+// 索引段文件：建立索引后一次写出，启动时用mmap映射，查询直接在映射的字节上进行，不做反序列化
+//
+// 文件格式（本机字节序，各区按8字节对齐）：
+//   SegmentHeader
+//   文档表  documentCount个SegmentDocument
+//   词典    termCount个SegmentTerm，按词升序排列
+//   字典树  （版本2起）词到词典序号的双数组字典树和字符编号表，按词查找时使用；
+//           版本1的段没有字典树，在词典中二分查找
+//   k-gram  （版本3起）k-gram到词典序号列表的索引，通配符查询时使用；
+//           更早的段没有k-gram索引，在前缀范围内逐个检查
+//   数据区  词和路径（UTF-16）、压缩倒排表、各文档的词位置表（检查点数组 + 编码字节）
+class Segment : public IndexReader {
+public:
+    static const quint32 VERSION = 3;
+
+    Segment();
+    ~Segment() override;
+
+    // 把索引写入文件，先写临时文件再替换，写入失败不会破坏原有的段
+    static bool write(const QString& filePath, const IndexReader& index, QString* errorMessage = nullptr);
+
+    bool open(const QString& filePath, QString* errorMessage = nullptr);   // 映射并校验段文件
+    void close();
+    bool isOpen() const { return base != nullptr; }
+    qint64 fileSize() const { return mappedSize; }
+
+    int documentCount() const override;
+    int documentLength(int docId) const override;
+    QString documentPath(int docId) const override;
+    TokenOffsetView tokenOffsets(int docId) const override;
+
+    PostingView postings(const QString& term) const override;
+    int termCount() const override;
+    void forEachTerm(const TermVisitor& visitor) const override;
+    void forEachTermWithPrefix(const QString& prefix, const TermVisitor& visitor) const override;
+    QString ceilingTerm(const QString& term) const override;
+    void forEachWildcardTerm(const QString& pattern, const TermVisitor& visitor) const override;
+
+    // 按词典顺序访问第index个词，用于合并段
+    QString termAt(int index) const;
+    PostingView postingsAt(int index) const;
+
+private:
+    struct Header;
+    struct DocumentEntry;
+    struct TermEntry;
+
+    bool validate(QString* errorMessage) const;
+    const Header* header() const;
+    const DocumentEntry* documents() const;
+    const TermEntry* terms() const;
+    QString stringAt(quint64 offset, quint32 length) const;
+    PostingView postingsOf(const TermEntry& entry) const;
+    int findTerm(const QString& term) const;       // 词的序号，不存在时返回-1
+    int lowerBound(const QString& term) const;     // 第一个不小于term的词的序号
+
+    QFile file;
+    uchar* base;
+    qint64 mappedSize;
+    TermTrieView trie;
+    KGramIndexView kgrams;
+};
+
+#endif // SEGMENT_H
@@ -0,0 +1,118 @@
+#include "segmentmerger.h"
+
+namespace {
+    // 合并后的段的只读视图，只提供写出段文件需要的接口：
+    // 文档按输入顺序拼接，词典按词序多路归并，倒排表在遍历时重新编码
+    class MergedIndex : public IndexReader {
+    public:
+        MergedIndex(const QVector<const Segment*>& segments, const QVector<QBitArray>& deleted,
+                    QVector<QVector<int>>& docMaps)
+            : segments(segments), docMaps(docMaps)
+        {
+            docMaps.resize(segments.size());
+            for (int i = 0; i < segments.size(); ++i) {
+                int count = segments[i]->documentCount();
+                docMaps[i].fill(-1, count);
+                for (int docId = 0; docId < count; ++docId) {
+                    if (docId < deleted[i].size() && deleted[i].testBit(docId)) {
+                        continue;
+                    }
+                    docMaps[i][docId] = documents.size();
+                    documents.append(qMakePair(i, docId));
+                }
+            }
+        }
+
+        int documentCount() const override { return documents.size(); }
+        int documentLength(int docId) const override { return source(docId)->documentLength(documents[docId].second); }
+        QString documentPath(int docId) const override { return source(docId)->documentPath(documents[docId].second); }
+        TokenOffsetView tokenOffsets(int docId) const override { return source(docId)->tokenOffsets(documents[docId].second); }
+
+        // 合并时不按词查询
+        PostingView postings(const QString&) const override { return PostingView(); }
+        void forEachTermWithPrefix(const QString&, const TermVisitor&) const override {}
+        QString ceilingTerm(const QString&) const override { return QString(); }
+
+        // 合并前无法知道去重后的词数，返回各输入段中最大的词数作为估计
+        int termCount() const override
+        {
+            int count = 0;
+            for (const Segment* segment : segments) {
+                count = qMax(count, segment->termCount());
+            }
+            return count;
+        }
+
+        void forEachTerm(const TermVisitor& visitor) const override
+        {
+            QVector<int> cursor(segments.size(), 0);
+            QVector<QString> current(segments.size());
+            for (int i = 0; i < segments.size(); ++i) {
+                if (segments[i]->termCount() > 0) {
+                    current[i] = segments[i]->termAt(0);
+                }
+            }
+
+            while (true) {
+                // 找出各段当前词中最小的一个，输入段很少，线性查找即可
+                int smallest = -1;
+                for (int i = 0; i < segments.size(); ++i) {
+                    if (cursor[i] < segments[i]->termCount()
+                        && (smallest < 0 || current[i] < current[smallest])) {
+                        smallest = i;
+                    }
+                }
+                if (smallest < 0) {
+                    break;
+                }
+                QString term = current[smallest];
+
+                // 按输入顺序追加各段中这个词的倒排表，新docId仍然递增
+                PostingList merged;
+                for (int i = 0; i < segments.size(); ++i) {
+                    if (cursor[i] >= segments[i]->termCount() || current[i] != term) {
+                        continue;
+                    }
+                    PostingIterator it = segments[i]->postingsAt(cursor[i]).iterator();
+                    while (it.next()) {
+                        int newId = docMaps[i][it.docId()];
+                        if (newId >= 0) {
+                            merged.add(newId, it.positions());
+                        }
+                    }
+                    if (++cursor[i] < segments[i]->termCount()) {
+                        current[i] = segments[i]->termAt(cursor[i]);
+                    }
+                }
+
+                // 只出现在已删除文档中的词不再写出
+                if (!merged.isEmpty()) {
+                    merged.finish();
+                    visitor(term, merged.view());
+                }
+            }
+        }
+
+    private:
+        const Segment* source(int docId) const { return segments[documents[docId].first]; }
+
+        QVector<const Segment*> segments;
+        QVector<QVector<int>>& docMaps;
+        QVector<QPair<int, int>> documents;   // 新docId -> (输入段, 旧docId)
+    };
+}
+
+bool SegmentMerger::merge(const QVector<const Segment*>& segments, const QVector<QBitArray>& deleted,
+                          const QString& outputPath, QVector<QVector<int>>* docMaps,
+                          QString* errorMessage)
+{
+    QVector<QVector<int>> maps;
+    MergedIndex merged(segments, deleted, maps);
+    if (!Segment::write(outputPath, merged, errorMessage)) {
+        return false;
+    }
+    if (docMaps) {
+        *docMaps = maps;
+    }
+    return true;
+}
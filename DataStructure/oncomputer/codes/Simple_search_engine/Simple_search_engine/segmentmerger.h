@@ -0,0 +1,19 @@
+#ifndef SEGMENTMERGER_H
+#define SEGMENTMERGER_H
+
+#include <QBitArray>
+#include <QString>
+#include <QVector>
+#include "segment.h"
+
+// 段合并：把若干个段合并为一个新段，跳过已删除的文档，其余文档按输入顺序重新编号。
+// 只读取输入段，可以在后台线程中执行
+class SegmentMerger {
+public:
+    // deleted[i]为第i个输入段的删除标记；docMaps[i][旧docId] = 新docId，已删除的文档为-1
+    static bool merge(const QVector<const Segment*>& segments, const QVector<QBitArray>& deleted,
+                      const QString& outputPath, QVector<QVector<int>>* docMaps,
+                      QString* errorMessage = nullptr);
+};
+
+#endif // SEGMENTMERGER_H
@@ -1,9 +1,33 @@
 #include "skiplist.h"
+#include <cstring>
+#include <random>
+#include <thread>
+
+SkipList::SkipNode::SkipNode(const QString& key, Version* version, int level)
+    : keyword(key), latest(version), level(level), forward(new std::atomic<SkipNode*>[level])
+{
+    for (int i = 0; i < level; i++) {
+        forward[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+SkipList::SkipNode::~SkipNode()
+{
+    Version* version = latest.load(std::memory_order_relaxed);
+    while (version) {
+        Version* previous = version->previous;
+        delete version;
+        version = previous;
+    }
+    for (char* buffer : buffers) {
+        delete[] buffer;
+    }
+    delete[] forward;
+}
 
 SkipList::SkipList()
-    : currentLevel(1), gen(rd()), dis(0, 1)
+    : head(new SkipNode(QString(), nullptr, MAX_LEVEL)), clock(0)
 {
-    head = new SkipNode();
 }
 
 SkipList::~SkipList()
@@ -14,6 +38,10 @@ SkipList::~SkipList()
 
 int SkipList::randomLevel()
 {
+    // 每个线程使用自己的随机数生成器
+    thread_local std::mt19937 gen(std::random_device{}());
+    thread_local std::uniform_real_distribution<> dis(0, 1);
+
     int level = 1;
     while (dis(gen) < 0.5 && level < MAX_LEVEL) {
         level++;
@@ -21,89 +49,207 @@ int SkipList::randomLevel()
     return level;
 }
 
-void SkipList::insert(const InvertedIndexNode& node)
+const SkipList::Version* SkipList::visibleVersion(const SkipNode* node, quint64 snapshot)
 {
-    QVector<SkipNode*> update(MAX_LEVEL, nullptr);
-    SkipNode* current = head;
-    
-    // 从最高层开始查找
-    for (int i = currentLevel - 1; i >= 0; i--) {
-        while (current->forward[i] && current->forward[i]->data.keyword < node.keyword) {
-            current = current->forward[i];
+    // 版本先链入再分配版本号，两步之间只有几条指令，读者遇到时等待即可。
+    // 快照读到的版本号不小于某个版本的版本号时，该版本一定已经链入，
+    // 所以同一快照看到的内容是确定的
+    for (const Version* version = node->latest.load(std::memory_order_acquire); version; version = version->previous) {
+        quint64 seq;
+        while ((seq = version->seq.load(std::memory_order_acquire)) == UNPUBLISHED) {
+            std::this_thread::yield();
+        }
+        if (seq <= snapshot) {
+            return version;
         }
-        update[i] = current;
     }
+    return nullptr;
+}
+
+SkipList::SkipNode* SkipList::findPosition(const QString& keyword, SkipNode** preds, SkipNode** succs) const
+{
+    SkipNode* current = head;
     
-    // 如果关键词已存在，更新文档列表
-    if (current->forward[0] && current->forward[0]->data.keyword == node.keyword) {
-        current->forward[0]->data.documents = node.documents;
-        return;
+    // 从最高层开始查找，每层记录最后一个小于关键词的节点和它的后继
+    for (int i = MAX_LEVEL - 1; i >= 0; i--) {
+        SkipNode* next = current->forward[i].load(std::memory_order_acquire);
+        while (next && next->keyword < keyword) {
+            current = next;
+            next = current->forward[i].load(std::memory_order_acquire);
+        }
+        preds[i] = current;
+        succs[i] = next;
     }
     
+    return succs[0] && succs[0]->keyword == keyword ? succs[0] : nullptr;
+}
+
+void SkipList::publish(Version* version)
+{
+    version->seq.store(clock.fetch_add(1, std::memory_order_acq_rel) + 1, std::memory_order_release);
+}
+
+bool SkipList::tryLink(const InvertedIndexNode& node, SkipNode** preds, SkipNode** succs)
+{
     // 生成随机层数
     int newLevel = randomLevel();
+    SkipNode* newNode = new SkipNode(node.keyword, new Version(node, nullptr), newLevel);
+    for (int i = 0; i < newLevel; i++) {
+        newNode->forward[i].store(succs[i], std::memory_order_relaxed);
+    }
     
-    // 如果新层数大于当前层数，更新head的指针
-    if (newLevel > currentLevel) {
-        for (int i = currentLevel; i < newLevel; i++) {
-            update[i] = head;
-        }
-        currentLevel = newLevel;
+    // 链入最底层后节点就存在了，失败说明这个位置被其他线程改变，由调用者重新查找
+    SkipNode* expected = succs[0];
+    if (!preds[0]->forward[0].compare_exchange_strong(expected, newNode, std::memory_order_acq_rel)) {
+        delete newNode;
+        return false;
     }
+    publish(newNode->latest.load(std::memory_order_relaxed));
     
-    // 创建新节点
-    SkipNode* newNode = new SkipNode(node, newLevel);
+    // 上层只用于加速查找，逐层链入，失败时重新查找这一层的位置
+    for (int i = 1; i < newLevel; i++) {
+        while (true) {
+            expected = succs[i];
+            if (preds[i]->forward[i].compare_exchange_strong(expected, newNode, std::memory_order_acq_rel)) {
+                break;
+            }
+            findPosition(node.keyword, preds, succs);
+            newNode->forward[i].store(succs[i], std::memory_order_release);
+        }
+    }
+    return true;
+}
+
+void SkipList::appendVersion(SkipNode* target, const InvertedIndexNode& node)
+{
+    // 同一关键词的拼接依次进行，写入缓冲区和发布新版本之间不会有其他拼接
+    while (target->appending.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    // 不修改已发布的字节：新文档写在最新版本的字节之后，旧版本只读自己的前缀。
+    // 第一次拼接时最新版本的字节还在自己的倒排表里，和缓冲区不够时一样换新缓冲区
+    Version* previous = target->latest.load(std::memory_order_acquire);
+    const QByteArray& published = previous->data.postings.data();
+    const QByteArray& added = node.postings.data();
+    const int size = published.size() + added.size();
+    if (target->buffers.isEmpty() || size > target->capacity) {
+        target->capacity = qMax(size * 2, 256);
+        char* buffer = new char[target->capacity];
+        std::memcpy(buffer, published.constData(), published.size());
+        target->buffers.append(buffer);
+    }
+    char* buffer = target->buffers.last();
+    std::memcpy(buffer + published.size(), added.constData(), added.size());
+
+    Version* version = new Version(previous->data, previous);
+    version->data.postings.appendShared(node.postings, buffer);
+    target->latest.store(version, std::memory_order_release);
+    publish(version);
+
+    target->appending.clear(std::memory_order_release);
+}
+
+void SkipList::insert(const InvertedIndexNode& node)
+{
+    SkipNode* preds[MAX_LEVEL];
+    SkipNode* succs[MAX_LEVEL];
     
-    // 更新指针
-    for (int i = 0; i < newLevel; i++) {
-        newNode->forward[i] = update[i]->forward[i];
-        update[i]->forward[i] = newNode;
+    while (true) {
+        // 如果关键词已存在，把新的文档拼接到已有倒排表之后
+        SkipNode* existing = findPosition(node.keyword, preds, succs);
+        if (existing) {
+            appendVersion(existing, node);
+            return;
+        }
+        if (tryLink(node, preds, succs)) {
+            return;
+        }
     }
 }
 
-InvertedIndexNode* SkipList::find(const QString& keyword)
+void SkipList::append(const InvertedIndexNode& node)
 {
+    SkipNode* preds[MAX_LEVEL];
+    SkipNode* succs[MAX_LEVEL];
     SkipNode* current = head;
     
-    // 从最高层开始查找
-    for (int i = currentLevel - 1; i >= 0; i--) {
-        while (current->forward[i] && current->forward[i]->data.keyword < keyword) {
-            current = current->forward[i];
+    // 新节点在表尾，每层走到最后一个节点即可，不需要比较关键词
+    for (int i = MAX_LEVEL - 1; i >= 0; i--) {
+        SkipNode* next;
+        while ((next = current->forward[i].load(std::memory_order_acquire))) {
+            current = next;
         }
+        preds[i] = current;
+        succs[i] = nullptr;
     }
     
-    current = current->forward[0];
+    // 表尾被其他线程改变时按普通插入处理
+    if (!tryLink(node, preds, succs)) {
+        insert(node);
+    }
+}
+
+const InvertedIndexNode* SkipList::find(const QString& keyword) const
+{
+    SkipNode* preds[MAX_LEVEL];
+    SkipNode* succs[MAX_LEVEL];
     
     // 检查是否找到关键词
-    if (current && current->data.keyword == keyword) {
-        return &(current->data);
+    SkipNode* node = findPosition(keyword, preds, succs);
+    if (!node) {
+        return nullptr;
     }
-    
-    return nullptr;
+    const Version* version = visibleVersion(node, snapshot());
+    return version ? &version->data : nullptr;
+}
+
+SkipList::Iterator SkipList::lowerBound(const QString& keyword) const
+{
+    SkipNode* preds[MAX_LEVEL];
+    SkipNode* succs[MAX_LEVEL];
+    findPosition(keyword, preds, succs);
+    return Iterator(succs[0], snapshot());
 }
 
 void SkipList::clear()
 {
-    SkipNode* current = head->forward[0];
+    SkipNode* current = head->forward[0].load(std::memory_order_relaxed);
     while (current) {
-        SkipNode* next = current->forward[0];
+        SkipNode* next = current->forward[0].load(std::memory_order_relaxed);
         delete current;
         current = next;
     }
     
     for (int i = 0; i < MAX_LEVEL; i++) {
-        head->forward[i] = nullptr;
+        head->forward[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+void SkipList::Iterator::skipInvisible()
+{
+    // 跳过快照之后才插入的节点
+    while (current) {
+        version = visibleVersion(current, snapshot);
+        if (version) {
+            return;
+        }
+        current = current->forward[0].load(std::memory_order_acquire);
     }
-    currentLevel = 1;
+}
+
+SkipList::Iterator& SkipList::Iterator::operator++()
+{
+    current = current->forward[0].load(std::memory_order_acquire);
+    skipInvisible();
+    return *this;
 }
 
 int SkipList::size() const
 {
     int count = 0;
-    SkipNode* current = head->forward[0];
-    while (current) {
+    for (auto it = begin(); it != end(); ++it) {
         count++;
-        current = current->forward[0];
     }
     return count;
-} 
\ No newline at end of file
+}
@@ -1,57 +1,96 @@
 #ifndef SKIPLIST_H
 #define SKIPLIST_H
 
+#include <QString>
 #include <QVector>
-#include <random>
+#include <QtGlobal>
+#include <atomic>
 #include "invertedindexnode.h"
 
+// 并发跳表：插入用CAS完成，不加锁；查找和遍历可以与插入同时进行。
+//   节点链入后不再移除（只有clear），读者沿原子指针前进即可；
+//   每次插入新关键词或拼接已有关键词都会得到一个递增的版本号，
+//   遍历时只看版本号不超过快照的内容，同一个快照无论何时遍历结果都相同；
+//   关键词已存在时不修改原来的倒排表，而是发布拼接后的新版本，旧版本保留到clear，
+//   正在使用旧版本的查询不受影响。
+//   拼接时各版本共用关键词的一块只追加的缓冲区，每个版本引用其中的一段前缀，
+//   每次拼接只写入新增的字节，N次拼接的时间和内存与倒排表的总长度成正比。
+// 同一关键词的并发插入依次拼接（只在这些插入之间等待），调用者需要保证docId递增并且倒排表已finish；
+// clear和析构时不能有其他线程访问
 class SkipList {
 private:
     static const int MAX_LEVEL = 16;  // 最大层数
-    
-    struct SkipNode {
+    static const quint64 UNPUBLISHED = ~0ULL;   // 已链入但还没有分配版本号
+
+    // 关键词的一个版本，按从新到旧链接
+    struct Version {
         InvertedIndexNode data;
-        QVector<SkipNode*> forward;
-        
-        SkipNode(const InvertedIndexNode& node, int level)
-            : data(node), forward(level, nullptr) {}
-            
-        SkipNode(int level = MAX_LEVEL)
-            : forward(level, nullptr) {}
+        std::atomic<quint64> seq;
+        Version* previous;
+
+        Version(const InvertedIndexNode& node, Version* prev)
+            : data(node), seq(UNPUBLISHED), previous(prev) {}
     };
-    
+
+    struct SkipNode {
+        QString keyword;
+        std::atomic<Version*> latest;
+        int level;
+        std::atomic<SkipNode*>* forward;
+
+        // 拼接用的缓冲区，最后一个是当前的，写满后换一个两倍大的，之前的留给旧版本；
+        // 只在持有appending时修改
+        std::atomic_flag appending = ATOMIC_FLAG_INIT;
+        QVector<char*> buffers;
+        int capacity = 0;
+
+        SkipNode(const QString& key, Version* version, int level);
+        ~SkipNode();
+    };
+
     SkipNode* head;
-    int currentLevel;
-    std::random_device rd;
-    std::mt19937 gen;
-    std::uniform_real_distribution<> dis;
+    std::atomic<quint64> clock;       // 最后分配的版本号
 
-    int randomLevel();
+    static int randomLevel();
+    static const Version* visibleVersion(const SkipNode* node, quint64 snapshot);
+    SkipNode* findPosition(const QString& keyword, SkipNode** preds, SkipNode** succs) const;
+    bool tryLink(const InvertedIndexNode& node, SkipNode** preds, SkipNode** succs);
+    void appendVersion(SkipNode* target, const InvertedIndexNode& node);
+    void publish(Version* version);
 
 public:
     SkipList();
     ~SkipList();
     
-    void insert(const InvertedIndexNode& node);
-    InvertedIndexNode* find(const QString& keyword);
+    void insert(const InvertedIndexNode& node);   // 线程安全
+    void append(const InvertedIndexNode& node);   // 关键词大于表中所有关键词时不需要比较，用于按升序批量建表
+    const InvertedIndexNode* find(const QString& keyword) const;   // 最新版本，线程安全
     void clear();
     
-    // 迭代器支持
+    // 快照：只包含此前完成的插入
+    quint64 snapshot() const { return clock.load(std::memory_order_acquire); }
+    
+    // 迭代器支持，遍历快照时刻的内容
     class Iterator {
     private:
         SkipNode* current;
+        const Version* version;
+        quint64 snapshot;
+        void skipInvisible();
     public:
-        Iterator(SkipNode* node) : current(node) {}
+        Iterator(SkipNode* node, quint64 snapshot) : current(node), version(nullptr), snapshot(snapshot) { skipInvisible(); }
         bool operator!=(const Iterator& other) const { return current != other.current; }
-        Iterator& operator++() { current = current->forward[0]; return *this; }
-        InvertedIndexNode& operator*() { return current->data; }
+        Iterator& operator++();
+        const InvertedIndexNode& operator*() const { return version->data; }
     };
     
-    Iterator begin() { return Iterator(head->forward[0]); }
-    Iterator end() { return Iterator(nullptr); }
+    Iterator begin() const { return Iterator(head->forward[0].load(std::memory_order_acquire), snapshot()); }
+    Iterator begin(quint64 snapshot) const { return Iterator(head->forward[0].load(std::memory_order_acquire), snapshot); }
+    Iterator end() const { return Iterator(nullptr, 0); }
+    Iterator lowerBound(const QString& keyword) const;   // 从第一个不小于keyword的关键词开始遍历
     
     // 获取大小
     int size() const;
 };
 
-#endif // SKIPLIST_H 
\ No newline at end of file
+#endif // SKIPLIST_H
@@ -0,0 +1,44 @@
+#include "snippetbuilder.h"
+
+QString SnippetBuilder::build(const QString& content, const TokenSpan& span, int contextChars)
+{
+    if (span.start < 0 || span.start >= content.length()) {
+        return QString();
+    }
+
+    int begin = qMax(0, span.start - contextChars);
+    int end = qMin(static_cast<int>(content.length()), span.start + span.length + contextChars);
+
+    QString snippet;
+    if (begin > 0) {
+        snippet += "...";
+    }
+    snippet += escape(content.mid(begin, span.start - begin));
+    snippet += "<b style='color:red;'>" + escape(content.mid(span.start, span.length)) + "</b>";
+    snippet += escape(content.mid(span.start + span.length, end - span.start - span.length));
+    if (end < content.length()) {
+        snippet += "...";
+    }
+
+    // 摘要显示在一行内
+    return snippet.replace('\n', ' ').replace('\r', ' ');
+}
+
+QString SnippetBuilder::highlightDocument(const QString& content, const TokenSpan& span)
+{
+    if (span.start < 0 || span.start >= content.length()) {
+        return escape(content).replace('\n', "<br>");
+    }
+
+    QString html = escape(content.left(span.start))
+                 + "<span style='background-color:yellow;'>"
+                 + escape(content.mid(span.start, span.length))
+                 + "</span>"
+                 + escape(content.mid(span.start + span.length));
+    return html.replace('\n', "<br>");
+}
+
+QString SnippetBuilder::escape(const QString& text)
+{
+    return text.toHtmlEscaped();
+}
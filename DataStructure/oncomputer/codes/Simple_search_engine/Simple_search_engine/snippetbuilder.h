@@ -0,0 +1,20 @@
+#ifndef SNIPPETBUILDER_H
+#define SNIPPETBUILDER_H
+
+#include <QString>
+#include "tokenoffsettable.h"
+
+// 摘要生成：查询时根据词位置表直接截取原文并高亮，索引中不保存任何上下文
+class SnippetBuilder {
+public:
+    // 截取关键词前后各contextChars个字符作为摘要
+    static QString build(const QString& content, const TokenSpan& span, int contextChars = 40);
+
+    // 生成整篇文档的HTML，并高亮指定位置的关键词
+    static QString highlightDocument(const QString& content, const TokenSpan& span);
+
+private:
+    static QString escape(const QString& text);
+};
+
+#endif // SNIPPETBUILDER_H
@@ -0,0 +1,125 @@
+#include "termdictionary.h"
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+TermDictionary::TermDictionary()
+{
+}
+
+void TermDictionary::add(int firstDocId, const QVector<InvertedIndexNode>& terms)
+{
+    // 先在本线程中按分片分组，每个分片只加锁一次
+    QVector<QVector<const InvertedIndexNode*>> groups(SHARD_COUNT);
+    for (const InvertedIndexNode& term : terms) {
+        groups[shardOf(term.keyword)].append(&term);
+    }
+
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        if (groups[i].isEmpty()) {
+            continue;
+        }
+        Shard& shard = shards[i];
+        QMutexLocker locker(&shard.mutex);
+        for (const InvertedIndexNode* term : groups[i]) {
+            Piece piece = { firstDocId, term->postings };
+            shard.terms[term->keyword].append(piece);
+        }
+    }
+}
+
+void TermDictionary::freezeShard(Shard& shard)
+{
+    shard.frozen.clear();
+    shard.frozen.reserve(shard.terms.size());
+    for (auto it = shard.terms.begin(); it != shard.terms.end(); ++it) {
+        // 批次的docId区间互不重叠，按批次顺序拼接后倒排表仍然有序
+        QVector<Piece>& pieces = it.value();
+        std::sort(pieces.begin(), pieces.end(), [](const Piece& a, const Piece& b) {
+            return a.firstDocId < b.firstDocId;
+        });
+
+        InvertedIndexNode node(it.key());
+        node.postings = pieces.first().postings;
+        for (int i = 1; i < pieces.size(); ++i) {
+            node.postings.append(pieces[i].postings);
+        }
+        shard.frozen.append(node);
+    }
+    shard.terms.clear();
+
+    std::sort(shard.frozen.begin(), shard.frozen.end(), [](const InvertedIndexNode& a, const InvertedIndexNode& b) {
+        return a.keyword < b.keyword;
+    });
+}
+
+void TermDictionary::freeze(SkipList& index)
+{
+    // 各分片互不相关，并行拼接和排序
+    QVector<Shard*> pending;
+    for (Shard& shard : shards) {
+        pending.append(&shard);
+    }
+    QtConcurrent::blockingMap(pending, [](Shard* shard) {
+        freezeShard(*shard);
+    });
+
+    // 归并各分片的有序结果，跳表按升序追加不需要比较关键词
+    typedef QPair<int, int> Cursor;   // 分片编号，分片中的下标
+    auto greater = [this](const Cursor& a, const Cursor& b) {
+        return shards[b.first].frozen[b.second].keyword < shards[a.first].frozen[a.second].keyword;
+    };
+    QVector<Cursor> heap;
+    for (int i = 0; i < SHARD_COUNT; ++i) {
+        if (!shards[i].frozen.isEmpty()) {
+            heap.append(Cursor(i, 0));
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), greater);
+
+    while (!heap.isEmpty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        Cursor& cursor = heap.last();
+        index.append(shards[cursor.first].frozen[cursor.second]);
+        if (++cursor.second < shards[cursor.first].frozen.size()) {
+            std::push_heap(heap.begin(), heap.end(), greater);
+        } else {
+            heap.removeLast();
+        }
+    }
+
+    for (Shard& shard : shards) {
+        shard.frozen = QVector<InvertedIndexNode>();
+    }
+}
+
+QStringList TermDictionary::terms() const
+{
+    QStringList result;
+    for (const Shard& shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        for (auto it = shard.terms.constBegin(); it != shard.terms.constEnd(); ++it) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+int TermDictionary::termCount() const
+{
+    int count = 0;
+    for (const Shard& shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        count += shard.terms.size();
+    }
+    return count;
+}
+
+void TermDictionary::clear()
+{
+    for (Shard& shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        shard.terms.clear();
+        shard.frozen.clear();
+    }
+}
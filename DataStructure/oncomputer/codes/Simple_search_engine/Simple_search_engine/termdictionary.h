@@ -0,0 +1,53 @@
+#ifndef TERMDICTIONARY_H
+#define TERMDICTIONARY_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "postinglist.h"
+#include "skiplist.h"
+
+// 并发词典：建立索引的工作线程把各自批次的倒排表直接加入词典，不再由主线程逐个合并。
+// 按关键词的哈希值分成SHARD_COUNT个分片，每个分片一把锁，一个批次对每个分片只加锁一次。
+// 批次完成的顺序不确定，同一关键词的各批次倒排表先分别保存，
+// freeze时各分片并行地按docId排序拼接、按关键词排序，再归并追加到跳表
+class TermDictionary {
+public:
+    static const int SHARD_COUNT = 64;   // 必须是2的幂
+
+    TermDictionary();
+
+    // 线程安全。firstDocId为批次中第一个文档的ID，各词的倒排表必须已finish且关键词互不相同
+    void add(int firstDocId, const QVector<InvertedIndexNode>& terms);
+
+    // 把全部关键词按升序追加到跳表，index中原有的关键词必须都小于词典中的关键词（通常为空表）。
+    // 之后词典被清空
+    void freeze(SkipList& index);
+
+    QStringList terms() const;
+    int termCount() const;
+    bool isEmpty() const { return termCount() == 0; }
+    void clear();
+
+private:
+    // 某个批次中一个关键词的倒排表
+    struct Piece {
+        int firstDocId;
+        PostingList postings;
+    };
+
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<QString, QVector<Piece>> terms;
+        QVector<InvertedIndexNode> frozen;   // freeze时按关键词排好序的结果
+    };
+
+    static int shardOf(const QString& term) { return static_cast<int>(qHash(term) & (SHARD_COUNT - 1)); }
+    static void freezeShard(Shard& shard);
+
+    Shard shards[SHARD_COUNT];
+};
+
+#endif // TERMDICTIONARY_H
@@ -0,0 +1,248 @@
+#include "termtrie.h"
+#include <algorithm>
+
+namespace {
+    // 构建时用双向链表串起空闲单元，为节点找base时只尝试空闲的位置；
+    // 一个位置尝试多次都放不下时不再尝试（仍然空闲），避免反复扫描数组前面已经很满的部分
+    class TrieBuilder {
+    public:
+        static const int MAX_ATTEMPTS = 16;
+
+        TrieBuilder(const QVector<QString>& terms, const TermTrieView& alphabet, QVector<TrieUnit>& units)
+            : terms(terms), alphabet(alphabet), units(units), firstFree(-1), lastFree(-1) {}
+
+        void build(int labelCount)
+        {
+            grow(labelCount + 1);
+            take(0);
+            units[0].check = 0;
+            insertChildren(0, 0, terms.size(), 0);
+
+            // 去掉末尾没有用到的单元，查找时越界即表示不存在
+            int used = units.size();
+            while (units[used - 1].check < 0) {
+                --used;
+            }
+            units.resize(used);
+        }
+
+    private:
+        int label(int term, int depth) const
+        {
+            const QString& text = terms[term];
+            return depth < text.length() ? alphabet.code(text.at(depth).unicode()) : 0;
+        }
+
+        // terms[lo, hi)共有长度为depth的前缀，为它们在parent下建立子节点
+        void insertChildren(int parent, int lo, int hi, int depth)
+        {
+            // 词已排序，下一个字符相同的词连续排列（编号按出现次数分配，不一定升序）
+            QVector<int> labels;
+            QVector<int> starts;
+            for (int i = lo; i < hi; ++i) {
+                int c = label(i, depth);
+                if (labels.isEmpty() || labels.last() != c) {
+                    labels.append(c);
+                    starts.append(i);
+                }
+            }
+            starts.append(hi);
+
+            int base = findBase(labels);
+            units[parent].base = base;
+            for (int c : labels) {
+                take(base + c);
+                units[base + c].check = parent;
+            }
+
+            // 只剩一个词时不再展开，叶子记录词的序号
+            for (int k = 0; k < labels.size(); ++k) {
+                int child = base + labels[k];
+                if (starts[k + 1] - starts[k] == 1) {
+                    units[child].base = -(starts[k] + 1);
+                } else {
+                    insertChildren(child, starts[k], starts[k + 1], depth + 1);
+                }
+            }
+        }
+
+        int findBase(const QVector<int>& labels)
+        {
+            const int first = labels.first();
+            const int last = *std::max_element(labels.constBegin(), labels.constEnd());
+            // 上一个节点占满了所有空闲单元时链表为空，先扩展数组
+            if (firstFree < 0) {
+                grow(units.size() + 1);
+            }
+            int position = firstFree;
+            while (true) {
+                int base = position - first;
+                if (base >= 1) {
+                    if (base + last >= units.size()) {
+                        grow(base + last + 1);
+                    }
+                    bool fits = true;
+                    for (int k = 1; k < labels.size() && fits; ++k) {
+                        fits = units[base + labels[k]].check < 0;
+                    }
+                    if (fits) {
+                        return base;
+                    }
+                }
+                if (next[position] < 0) {
+                    grow(units.size() + 1);
+                }
+                int failed = position;
+                position = next[position];
+                if (++attempts[failed] == MAX_ATTEMPTS) {
+                    take(failed);
+                    if (firstFree < 0) {
+                        grow(units.size() + 1);
+                    }
+                }
+            }
+        }
+
+        void grow(int minimumSize)
+        {
+            int oldSize = units.size();
+            int newSize = qMax(minimumSize, oldSize + oldSize / 2);
+            units.resize(newSize);
+            next.resize(newSize);
+            previous.resize(newSize);
+            attempts.resize(newSize);
+            for (int i = oldSize; i < newSize; ++i) {
+                units[i].base = 0;
+                units[i].check = -1;
+                attempts[i] = 0;
+                previous[i] = i == oldSize ? lastFree : i - 1;
+                next[i] = i + 1 < newSize ? i + 1 : -1;
+            }
+            if (lastFree >= 0) {
+                next[lastFree] = oldSize;
+            } else {
+                firstFree = oldSize;
+            }
+            lastFree = newSize - 1;
+        }
+
+        // 把单元从空闲链表中取出，已经取出的不再处理
+        void take(int position)
+        {
+            if (attempts[position] > MAX_ATTEMPTS) {
+                return;
+            }
+            attempts[position] = MAX_ATTEMPTS + 1;
+            if (previous[position] >= 0) {
+                next[previous[position]] = next[position];
+            } else {
+                firstFree = next[position];
+            }
+            if (next[position] >= 0) {
+                previous[next[position]] = previous[position];
+            } else {
+                lastFree = previous[position];
+            }
+        }
+
+        const QVector<QString>& terms;
+        const TermTrieView& alphabet;
+        QVector<TrieUnit>& units;
+        QVector<int> next;
+        QVector<int> previous;
+        QVector<uchar> attempts;
+        int firstFree;
+        int lastFree;
+    };
+}
+
+int TermTrieView::find(const QString& term) const
+{
+    if (size == 0) {
+        return -1;
+    }
+
+    const ushort* chars = term.utf16();
+    const int length = term.length();
+    int state = 0;
+    for (int depth = 0; ; ++depth) {
+        int base = units[state].base;
+        if (base < 0) {
+            return -base - 1;
+        }
+        int c = 0;
+        if (depth < length) {
+            c = code(chars[depth]);
+            if (c == 0) {
+                return -1;
+            }
+        }
+        int child = base + c;
+        if (child >= size || units[child].check != state) {
+            return -1;
+        }
+        state = child;
+    }
+}
+
+void TermTrie::build(const QVector<QString>& terms)
+{
+    clear();
+    if (terms.isEmpty()) {
+        return;
+    }
+
+    // 按出现次数给字符编号，从1开始，0留给词的结尾
+    QVector<int> counts(0x10000, 0);
+    for (const QString& term : terms) {
+        for (const QChar& ch : term) {
+            counts[ch.unicode()]++;
+        }
+    }
+    QVector<ushort> alphabet;
+    for (int ch = 0; ch < counts.size(); ++ch) {
+        if (counts[ch] > 0) {
+            alphabet.append(static_cast<ushort>(ch));
+        }
+    }
+    std::stable_sort(alphabet.begin(), alphabet.end(), [&counts](ushort a, ushort b) {
+        return counts[a] > counts[b];
+    });
+
+    pages.fill(0, TermTrieView::PAGE_COUNT);
+    for (int i = 0; i < alphabet.size(); ++i) {
+        ushort ch = alphabet[i];
+        quint16& page = pages[ch >> 8];
+        if (page == 0) {
+            codes.resize(codes.size() + TermTrieView::PAGE_SIZE);
+            page = static_cast<quint16>(codes.size() / TermTrieView::PAGE_SIZE);
+        }
+        codes[(page - 1) * TermTrieView::PAGE_SIZE + (ch & 0xFF)] = static_cast<quint16>(i + 1);
+    }
+
+    TermTrieView table = view();
+    TrieBuilder(terms, table, units).build(alphabet.size() + 1);
+}
+
+void TermTrie::clear()
+{
+    units.clear();
+    pages.clear();
+    codes.clear();
+}
+
+TermTrieView TermTrie::view() const
+{
+    TermTrieView view;
+    view.units = units.constData();
+    view.size = units.size();
+    view.pages = pages.constData();
+    view.codes = codes.constData();
+    view.codePageCount = codes.size() / TermTrieView::PAGE_SIZE;
+    return view;
+}
+
+qint64 TermTrie::memoryUsage() const
+{
+    return qint64(units.size()) * sizeof(TrieUnit) + (pages.size() + codes.size()) * sizeof(quint16);
+}
@@ -0,0 +1,62 @@
+#ifndef TERMTRIE_H
+#define TERMTRIE_H
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// 双数组中的一个单元
+//   check：父节点的下标，-1表示空闲
+//   base：内部节点编号为c的字符的子节点在base + c，词在此结束的子节点在base；
+//         叶子节点为-(词的序号 + 1)
+struct TrieUnit {
+    qint32 base;
+    qint32 check;
+};
+
+// 只读的双数组字典树，可以直接指向段文件中映射的数据
+// 字符编号表分两级：pages按字符的高8位给出码表页号加1（0表示这一页没有字符），
+// 每页256个编号，按字符的低8位查找，0表示字符没有出现过
+struct TermTrieView {
+    static const int PAGE_COUNT = 256;
+    static const int PAGE_SIZE = 256;
+
+    const TrieUnit* units = nullptr;
+    int size = 0;
+    const quint16* pages = nullptr;     // PAGE_COUNT项
+    const quint16* codes = nullptr;     // codePageCount * PAGE_SIZE项
+    int codePageCount = 0;
+
+    bool isEmpty() const { return size == 0; }
+
+    int code(ushort ch) const
+    {
+        int page = pages[ch >> 8];
+        return page ? codes[(page - 1) * PAGE_SIZE + (ch & 0xFF)] : 0;
+    }
+
+    // 只有一个词经过的后缀不展开，走到叶子就返回，
+    // 返回的序号需要与词典中的词比较确认；-1表示一定不存在
+    int find(const QString& term) const;
+};
+
+// 双数组字典树：把按升序排列的词映射为词在词典中的序号。
+//   按UTF-16码元分支，只为多个词共有的前缀建立内部节点，其余字符留在词典里；
+//   字符按出现次数重新编号，常用字编号小，子节点集中，数组更紧凑。
+//   每个节点只占8字节，查找时每个字符只访问一个数组单元
+class TermTrie {
+public:
+    // terms按QString的顺序升序排列且没有重复
+    void build(const QVector<QString>& terms);
+    void clear();
+
+    TermTrieView view() const;
+    qint64 memoryUsage() const;
+
+private:
+    QVector<TrieUnit> units;
+    QVector<quint16> pages;
+    QVector<quint16> codes;
+};
+
+#endif // TERMTRIE_H
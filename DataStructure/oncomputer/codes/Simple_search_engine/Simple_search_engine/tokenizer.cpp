@@ -0,0 +1,88 @@
+#include "tokenizer.h"
+#include <algorithm>
+
+// 按QChar的规则生成：标点和空白为分隔符，字母和数字为Letter，其余为Symbol
+const uchar Tokenizer::ASCII_CLASSES[128] = {
+#define Y Symbol
+#define L Letter
+#define S Separator
+    Y, Y, Y, Y, Y, Y, Y, Y, Y, S, S, S, S, S, Y, Y,     // 0x00  \t \n \v \f \r
+    Y, Y, Y, Y, Y, Y, Y, Y, Y, Y, Y, Y, Y, Y, Y, Y,     // 0x10
+    S, S, S, S, Y, S, S, S, S, S, S, Y, S, S, S, S,     // 0x20  空格 !"#$%&'()*+,-./
+    L, L, L, L, L, L, L, L, L, L, S, S, Y, Y, Y, S,     // 0x30  0-9 :;<=>?
+    S, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L,     // 0x40  @A-O
+    L, L, L, L, L, L, L, L, L, L, L, S, S, S, Y, S,     // 0x50  P-Z [\]^_
+    Y, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L,     // 0x60  `a-o
+    L, L, L, L, L, L, L, L, L, L, L, S, Y, S, Y, Y      // 0x70  p-z {|}~
+#undef Y
+#undef L
+#undef S
+};
+
+Tokenizer::CharClass Tokenizer::otherClass(ushort ch)
+{
+    QChar c(ch);
+    if (c.isPunct() || c.isSpace()) {
+        return Separator;
+    }
+    return c.isLetterOrNumber() ? Letter : Symbol;
+}
+
+QString Tokenizer::termText(const QString& text, const Token& token)
+{
+    if (token.kind != Token::Word) {
+        return text.mid(token.start, token.length);
+    }
+
+    // 去掉词中夹杂的符号后转为小写
+    QString word;
+    word.reserve(token.length);
+    const ushort* data = text.utf16();
+    for (int i = token.start; i < token.start + token.length; ++i) {
+        if (isLetterOrNumber(data[i])) {
+            word.append(QChar(data[i]));
+        }
+    }
+    return word.toLower();
+}
+
+bool Tokenizer::sameTerm(const QString& a, const Token& x, const QString& b, const Token& y)
+{
+    if (x.hash != y.hash) {
+        return false;
+    }
+
+    const ushort* p = a.utf16() + x.start;
+    const ushort* q = b.utf16() + y.start;
+    const ushort* pEnd = p + x.length;
+    const ushort* qEnd = q + y.length;
+
+    // 中文词直接比较字符
+    if (x.kind != Token::Word && y.kind != Token::Word) {
+        return x.length == y.length && std::equal(p, pEnd, q);
+    }
+
+    // 字母数字词按索引形式比较：跳过符号，忽略大小写
+    while (true) {
+        if (x.kind == Token::Word) {
+            while (p < pEnd && !isLetterOrNumber(*p)) {
+                ++p;
+            }
+        }
+        if (y.kind == Token::Word) {
+            while (q < qEnd && !isLetterOrNumber(*q)) {
+                ++q;
+            }
+        }
+        if (p == pEnd || q == qEnd) {
+            return p == pEnd && q == qEnd;
+        }
+        ushort c = x.kind == Token::Word ? toLower(*p) : *p;
+        ushort d = y.kind == Token::Word ? toLower(*q) : *q;
+        if (c != d) {
+            return false;
+        }
+        ++p;
+        ++q;
+    }
+}
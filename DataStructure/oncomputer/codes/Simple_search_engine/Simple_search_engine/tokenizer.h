@@ -0,0 +1,202 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <QChar>
+#include <QString>
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// 分词得到的一个词：只记录它在原文中的区间，不复制字符
+struct Token {
+    enum Kind {
+        Word,          // 字母和数字组成的词，索引形式为小写；词中夹杂的符号被忽略
+        ChineseRun,    // 连续的中文字符组成的词组
+        ChineseChar    // 词组中的单个字，依次紧跟在词组之后
+    };
+
+    int start;         // 起始字符下标
+    int length;        // 字符数
+    Kind kind;
+    uint hash;         // 索引形式的哈希值
+};
+
+// 零拷贝分词器：只扫描一遍原文，按顺序把每个词交给回调，同时计算哈希值，不分配内存。
+//   中文字符（U+4E00 ~ U+9FFF）连续的一段作为一个词组，其后再逐字输出，以支持单字搜索；
+//   标点和空白分隔词；其他字母和数字连成一个词，其余符号被跳过但不分隔词。
+//   ASCII字符查分类表；遇到中文字符时用SSE2/AVX2一次比较一块字符，按掩码整段计入词组；
+//   只有非ASCII的其他字符才用QChar判断
+class Tokenizer {
+public:
+    // visitor(const Token&)
+    template <typename Visitor>
+    static void tokenize(const QString& text, Visitor&& visitor);
+
+    static QString termText(const QString& text, const Token& token);     // 词的索引形式
+    static bool sameTerm(const QString& a, const Token& x, const QString& b, const Token& y);
+
+    static bool isChinese(ushort ch) { return ch >= 0x4E00 && ch <= 0x9FFF; }
+
+    // 字符分类
+    enum CharClass {
+        Symbol,       // 其他符号：跳过，但不分隔词
+        Letter,       // 字母或数字
+        Chinese,      // 中文字符
+        Separator     // 标点或空白
+    };
+
+#if defined(__AVX2__)
+    static const int BLOCK_SIZE = 16;
+#elif defined(__SSE2__)
+    static const int BLOCK_SIZE = 8;
+#else
+    static const int BLOCK_SIZE = 1;
+#endif
+
+    // 一块字符中哪些是中文字符，第k位对应块中第k个字符；data中至少有BLOCK_SIZE个字符
+    static uint chineseMask(const ushort* data);
+    static CharClass classOf(ushort ch);
+
+private:
+    static const uchar ASCII_CLASSES[128];
+
+    // FNV-1a
+    static const uint HASH_SEED = 2166136261u;
+    static uint mix(uint hash, ushort ch) { return (hash ^ ch) * 16777619u; }
+
+    static bool isLetterOrNumber(ushort ch)
+    {
+        if (ch < 0x80) {
+            return ASCII_CLASSES[ch] == Letter;
+        }
+        return QChar(ch).isLetterOrNumber();
+    }
+
+    static ushort toLower(ushort ch)
+    {
+        if (ch < 0x80) {
+            return ch >= 'A' && ch <= 'Z' ? ch | 0x20 : ch;
+        }
+        return QChar(ch).toLower().unicode();
+    }
+
+    static CharClass otherClass(ushort ch);   // 既不是ASCII也不是中文的字符
+};
+
+inline uint Tokenizer::chineseMask(const ushort* data)
+{
+    // 没有无符号16位比较，各字符异或0x8000后按有符号数比较
+#if defined(__AVX2__)
+    const __m256i flip = _mm256_set1_epi16(static_cast<short>(0x8000));
+    __m256i flipped = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), flip);
+    __m256i chinese = _mm256_and_si256(
+        _mm256_cmpgt_epi16(flipped, _mm256_set1_epi16(static_cast<short>((0x4E00 - 1) ^ 0x8000))),
+        _mm256_cmpgt_epi16(_mm256_set1_epi16(static_cast<short>((0x9FFF + 1) ^ 0x8000)), flipped));
+    // 按128位分别打包成字节：[0-7, 0, 8-15, 0]
+    uint bits = static_cast<uint>(_mm256_movemask_epi8(_mm256_packs_epi16(chinese, _mm256_setzero_si256())));
+    return (bits & 0xFF) | ((bits >> 8) & 0xFF00);
+#elif defined(__SSE2__)
+    const __m128i flip = _mm_set1_epi16(static_cast<short>(0x8000));
+    __m128i flipped = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), flip);
+    __m128i chinese = _mm_and_si128(
+        _mm_cmpgt_epi16(flipped, _mm_set1_epi16(static_cast<short>((0x4E00 - 1) ^ 0x8000))),
+        _mm_cmplt_epi16(flipped, _mm_set1_epi16(static_cast<short>((0x9FFF + 1) ^ 0x8000))));
+    return static_cast<uint>(_mm_movemask_epi8(_mm_packs_epi16(chinese, _mm_setzero_si128())));
+#else
+    return isChinese(data[0]) ? 1u : 0u;
+#endif
+}
+
+inline Tokenizer::CharClass Tokenizer::classOf(ushort ch)
+{
+    if (ch < 0x80) {
+        return static_cast<CharClass>(ASCII_CLASSES[ch]);
+    }
+    return isChinese(ch) ? Chinese : otherClass(ch);
+}
+
+template <typename Visitor>
+void Tokenizer::tokenize(const QString& text, Visitor&& visitor)
+{
+    const ushort* data = text.utf16();
+    const int size = text.length();
+
+    int wordStart = -1;     // -1表示当前没有词
+    int wordEnd = 0;
+    uint wordHash = HASH_SEED;
+    int runStart = -1;      // -1表示当前没有中文词组
+    uint runHash = HASH_SEED;
+
+    auto flushWord = [&]() {
+        if (wordStart < 0) {
+            return;
+        }
+        visitor(Token{ wordStart, wordEnd - wordStart, Token::Word, wordHash });
+        wordStart = -1;
+    };
+
+    // 先输出词组，再逐字输出
+    auto flushRun = [&](int end) {
+        if (runStart < 0) {
+            return;
+        }
+        visitor(Token{ runStart, end - runStart, Token::ChineseRun, runHash });
+        for (int k = runStart; k < end; ++k) {
+            visitor(Token{ k, 1, Token::ChineseChar, mix(HASH_SEED, data[k]) });
+        }
+        runStart = -1;
+    };
+
+    // 连续的中文字符直接计入词组
+    auto appendChinese = [&](int from, int to) {
+        flushWord();
+        if (runStart < 0) {
+            runStart = from;
+            runHash = HASH_SEED;
+        }
+        for (int k = from; k < to; ++k) {
+            runHash = mix(runHash, data[k]);
+        }
+    };
+
+    for (int i = 0; i < size; ++i) {
+        const ushort ch = data[i];
+        switch (classOf(ch)) {
+        case Chinese:
+            // 从这个字符开始比较一块，按掩码一次计入连续的一段中文字符
+            if (BLOCK_SIZE > 1 && i + BLOCK_SIZE <= size) {
+                int length = qCountTrailingZeroBits(~chineseMask(data + i));
+                appendChinese(i, i + length);
+                i += length - 1;
+            } else {
+                appendChinese(i, i + 1);
+            }
+            break;
+        case Separator:
+            flushWord();
+            flushRun(i);
+            break;
+        case Letter:
+            // 中文词组只由连续的中文字符组成
+            flushRun(i);
+            if (wordStart < 0) {
+                wordStart = i;
+                wordHash = HASH_SEED;
+            }
+            wordHash = mix(wordHash, toLower(ch));
+            wordEnd = i + 1;
+            break;
+        default:
+            flushRun(i);
+            break;
+        }
+    }
+
+    flushWord();
+    flushRun(size);
+}
+
+#endif // TOKENIZER_H
@@ -0,0 +1,82 @@
+#include "tokenoffsettable.h"
+#include "postinglist.h"
+
+TokenOffsetTable::TokenOffsetTable()
+    : count(0), lastStart(0)
+{
+}
+
+void TokenOffsetTable::append(int start, int length)
+{
+    if (count % CHECKPOINT_INTERVAL == 0) {
+        checkpoints.append(bytes.size());
+        VarInt::encode(bytes, start);
+    } else {
+        VarInt::encode(bytes, start - lastStart);
+    }
+    VarInt::encode(bytes, length);
+
+    lastStart = start;
+    count++;
+}
+
+void TokenOffsetTable::finish()
+{
+    bytes.squeeze();
+    checkpoints.squeeze();
+}
+
+void TokenOffsetTable::clear()
+{
+    bytes.clear();
+    checkpoints.clear();
+    count = 0;
+    lastStart = 0;
+}
+
+TokenOffsetView TokenOffsetTable::view() const
+{
+    TokenOffsetView result;
+    result.bytes = bytes.constData();
+    result.byteCount = bytes.size();
+    result.checkpoints = checkpoints.constData();
+    result.checkpointCount = checkpoints.size();
+    result.count = count;
+    return result;
+}
+
+TokenSpan TokenOffsetView::span(int index) const
+{
+    if (index < 0 || index >= count) {
+        return TokenSpan(-1, 0);
+    }
+
+    // 从最近的检查点开始解码
+    int first = index - index % TokenOffsetTable::CHECKPOINT_INTERVAL;
+    const uchar* p = reinterpret_cast<const uchar*>(bytes) + checkpoints[index / TokenOffsetTable::CHECKPOINT_INTERVAL];
+
+    int start = static_cast<int>(VarInt::decode(p));
+    int length = static_cast<int>(VarInt::decode(p));
+    for (int i = first + 1; i <= index; ++i) {
+        start += static_cast<int>(VarInt::decode(p));
+        length = static_cast<int>(VarInt::decode(p));
+    }
+    return TokenSpan(start, length);
+}
+
+TokenSpan TokenOffsetView::span(int first, int count) const
+{
+    TokenSpan head = span(first);
+    if (count <= 1 || head.start < 0) {
+        return head;
+    }
+
+    // 中文词组与它的单字重叠，区间的终点取最后一个词的终点
+    TokenSpan tail = span(qMin(first + count, this->count) - 1);
+    return TokenSpan(head.start, qMax(head.length, tail.start + tail.length - head.start));
+}
+
+qint64 TokenOffsetTable::memoryUsage() const
+{
+    return sizeof(TokenOffsetTable) + bytes.capacity() + checkpoints.capacity() * sizeof(int);
+}
@@ -0,0 +1,56 @@
+#ifndef TOKENOFFSETTABLE_H
+#define TOKENOFFSETTABLE_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+// 词在原文中的字符区间
+struct TokenSpan {
+    int start;     // 起始字符下标
+    int length;    // 字符数
+
+    TokenSpan(int s = 0, int l = 0) : start(s), length(l) {}
+};
+
+// 只读的词位置表，可以指向内存中的TokenOffsetTable，也可以指向映射到内存的段文件
+struct TokenOffsetView {
+    const char* bytes = nullptr;
+    int byteCount = 0;
+    const int* checkpoints = nullptr;
+    int checkpointCount = 0;
+    int count = 0;
+
+    TokenSpan span(int index) const;              // 取第index个词的区间
+    TokenSpan span(int first, int count) const;   // 从第first个词开始连续count个词覆盖的区间
+};
+
+// 文档的词位置表：第i个词 -> 原文中的字符区间
+//
+// 每个词编码为 varint(起始位置) varint(长度)，起始位置存与前一个词的差值；
+// 每隔CHECKPOINT_INTERVAL个词存一次绝对起始位置并记录字节偏移，
+// 查询时只解码一小段即可定位任意词，平均每个词约占2个字节
+class TokenOffsetTable {
+public:
+    static const int CHECKPOINT_INTERVAL = 64;
+
+    TokenOffsetTable();
+
+    void append(int start, int length);   // 词的起始位置必须非递减
+    void finish();                        // 释放多余容量
+    void clear();
+
+    int size() const { return count; }
+    TokenSpan span(int index) const { return view().span(index); }
+    TokenSpan span(int first, int count) const { return view().span(first, count); }
+    TokenOffsetView view() const;
+    qint64 memoryUsage() const;
+
+private:
+    QByteArray bytes;
+    QVector<int> checkpoints;   // 第 k*CHECKPOINT_INTERVAL 个词在bytes中的偏移
+    int count;
+    int lastStart;
+};
+
+#endif // TOKENOFFSETTABLE_H
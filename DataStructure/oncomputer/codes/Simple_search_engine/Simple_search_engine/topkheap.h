@@ -0,0 +1,87 @@
+#ifndef TOPKHEAP_H
+#define TOPKHEAP_H
+
+#include <QPair>
+#include <QVector>
+#include <algorithm>
+#include "invertedindexnode.h"
+
+// 固定容量的最小堆，只保留分数最高的k个结果，堆顶是当前第k名
+class TopKHeap {
+public:
+    explicit TopKHeap(int k) : capacity(qMax(1, k)) { heap.reserve(capacity); }
+
+    int size() const { return heap.size(); }
+    bool isFull() const { return heap.size() >= capacity; }
+
+    // 进入前k名需要超过的分数，堆未满时为0
+    double threshold() const { return isFull() ? heap.first().weight : 0.0; }
+
+    bool accepts(double score) const { return !isFull() || score > heap.first().weight; }
+
+    void push(const DocumentNode& node)
+    {
+        if (!isFull()) {
+            heap.append(node);
+            std::push_heap(heap.begin(), heap.end(), worse);
+        } else if (node.weight > heap.first().weight) {
+            std::pop_heap(heap.begin(), heap.end(), worse);
+            heap.last() = node;
+            std::push_heap(heap.begin(), heap.end(), worse);
+        }
+    }
+
+    // 按分数从高到低取出全部结果，分数相同时docId小的在前
+    QVector<DocumentNode> takeSorted()
+    {
+        std::sort_heap(heap.begin(), heap.end(), worse);
+        QVector<DocumentNode> result;
+        result.swap(heap);
+        return result;
+    }
+
+    // 多路归并各分片takeSorted的结果，取前k个；各分片的docId互不相同，
+    // 结果与所有文档放进同一个堆相同
+    static QVector<DocumentNode> merge(const QVector<QVector<DocumentNode>>& lists, int k)
+    {
+        typedef QPair<int, int> Cursor;   // 分片编号，分片结果中的下标
+        auto later = [&lists](const Cursor& a, const Cursor& b) {
+            return worse(lists[b.first][b.second], lists[a.first][a.second]);
+        };
+        QVector<Cursor> heap;
+        for (int i = 0; i < lists.size(); ++i) {
+            if (!lists[i].isEmpty()) {
+                heap.append(Cursor(i, 0));
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), later);
+
+        QVector<DocumentNode> result;
+        while (!heap.isEmpty() && result.size() < k) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            Cursor& cursor = heap.last();
+            result.append(lists[cursor.first][cursor.second]);
+            if (++cursor.second < lists[cursor.first].size()) {
+                std::push_heap(heap.begin(), heap.end(), later);
+            } else {
+                heap.removeLast();
+            }
+        }
+        return result;
+    }
+
+private:
+    // 堆的比较函数：a比b排名更靠前时返回true，使堆顶为排名最后的结果
+    static bool worse(const DocumentNode& a, const DocumentNode& b)
+    {
+        if (a.weight != b.weight) {
+            return a.weight > b.weight;
+        }
+        return a.docId < b.docId;
+    }
+
+    int capacity;
+    QVector<DocumentNode> heap;
+};
+
+#endif // TOPKHEAP_H
@@ -0,0 +1,70 @@
+#include "wildcard.h"
+
+namespace {
+    inline bool isWildcardChar(QChar ch)
+    {
+        return ch == '*' || ch == '?';
+    }
+}
+
+bool Wildcard::isPattern(const QString& text)
+{
+    for (QChar ch : text) {
+        if (isWildcardChar(ch)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Wildcard::matches(const QString& pattern, const QString& term)
+{
+    // 贪心匹配，不匹配时回到上一个*，让它多匹配一个字符；只需记住最后一个*
+    int p = 0;
+    int t = 0;
+    int star = -1;
+    int starMatch = 0;
+    while (t < term.length()) {
+        if (p < pattern.length() && (pattern.at(p) == '?' || pattern.at(p) == term.at(t))) {
+            ++p;
+            ++t;
+        } else if (p < pattern.length() && pattern.at(p) == '*') {
+            star = p++;
+            starMatch = t;
+        } else if (star >= 0) {
+            p = star + 1;
+            t = ++starMatch;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.length() && pattern.at(p) == '*') {
+        ++p;
+    }
+    return p == pattern.length();
+}
+
+QString Wildcard::literalPrefix(const QString& pattern)
+{
+    int i = 0;
+    while (i < pattern.length() && !isWildcardChar(pattern.at(i))) {
+        ++i;
+    }
+    return pattern.left(i);
+}
+
+int Wildcard::literalLength(const QString& pattern)
+{
+    int count = 0;
+    for (QChar ch : pattern) {
+        if (!isWildcardChar(ch)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool Wildcard::isPrefixPattern(const QString& pattern)
+{
+    return pattern.endsWith('*') && literalPrefix(pattern).length() == pattern.length() - 1;
+}
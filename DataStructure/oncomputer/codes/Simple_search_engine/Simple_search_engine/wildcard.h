@@ -0,0 +1,17 @@
+#ifndef WILDCARD_H
+#define WILDCARD_H
+
+#include <QString>
+
+// 通配符模式：* 匹配任意多个字符（包括0个），? 匹配一个字符，其余字符按原样比较。
+// 模式与索引词一样为小写
+class Wildcard {
+public:
+    static bool isPattern(const QString& text);                   // 是否含有通配符
+    static bool matches(const QString& pattern, const QString& term);
+    static QString literalPrefix(const QString& pattern);         // 第一个通配符之前的部分
+    static int literalLength(const QString& pattern);             // 非通配符的字符数
+    static bool isPrefixPattern(const QString& pattern);          // 形如 abc*：只有末尾一个*
+};
+
+#endif // WILDCARD_H